@@ -8,36 +8,51 @@ C_SRCS += \
 ../control.c \
 ../external_eeprom.c \
 ../gpio.c \
+../input.c \
 ../motor.c \
 ../pir.c \
+../profiler.c \
 ../pwm.c \
+../rtc.c \
+../scheduler.c \
 ../timer.c \
 ../twi.c \
-../uart.c 
+../uart.c \
+../watchdog.c 
 
 OBJS += \
 ./buzzer.o \
 ./control.o \
 ./external_eeprom.o \
 ./gpio.o \
+./input.o \
 ./motor.o \
 ./pir.o \
+./profiler.o \
 ./pwm.o \
+./rtc.o \
+./scheduler.o \
 ./timer.o \
 ./twi.o \
-./uart.o 
+./uart.o \
+./watchdog.o 
 
 C_DEPS += \
 ./buzzer.d \
 ./control.d \
 ./external_eeprom.d \
 ./gpio.d \
+./input.d \
 ./motor.d \
 ./pir.d \
+./profiler.d \
 ./pwm.d \
+./rtc.d \
+./scheduler.d \
 ./timer.d \
 ./twi.d \
-./uart.d 
+./uart.d \
+./watchdog.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -18,14 +18,14 @@
  * This function initializes the buzzer pin to be set to OUTPUT
  */
 void BUZZER_init(void){
-	GPIO_setupPinDirection(BUZZER_PORT_ID, BUZZER_PIN_ID, PIN_OUTPUT);
+	GPIO_PIN_OUTPUT(BUZZER_PIN);
 }
 /*
  * Description:
  * This function sets the buzzer pin to LOGIC_HIGH, hence activating the buzzer
  */
 void BUZZER_on(void){
-	GPIO_writePin(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_HIGH);
+	GPIO_PIN_HIGH(BUZZER_PIN);
 }
 /*
  * Description:
@@ -33,7 +33,7 @@ void BUZZER_on(void){
  */
 
 void BUZZER_off(void){
-	GPIO_writePin(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_LOW);
+	GPIO_PIN_LOW(BUZZER_PIN);
 }
 
 
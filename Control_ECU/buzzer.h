@@ -12,8 +12,11 @@
  * 					 Pre-Processor Constants and Configurations
  *----------------------------------------------------------------------------*/
 
-#define BUZZER_PORT_ID				PORTC_ID
-#define BUZZER_PIN_ID				PIN7_ID
+/*
+ * PC6/PC7 are the RTC crystal pins (TOSC1/TOSC2) and PC2 - PC5 the JTAG pins,
+ * PORTA is not used by the other drivers of the Control ECU
+ */
+#define BUZZER_PIN					A, 0
 
 /*------------------------------------------------------------------------------
  *  							Function Declarations
@@ -10,14 +10,18 @@
 #include "common_macros.h"
 #include "external_eeprom.h"
 #include "gpio.h"
+#include "input.h"
 #include "motor.h"
 #include "pir.h"
+#include "profiler.h"
+#include "rtc.h"
 #include "pwm.h"
+#include "scheduler.h"
 #include "timer.h"
 #include "twi.h"
 #include "uart.h"
+#include "watchdog.h"
 #include "avr/io.h"
-#include "util/delay.h"
 
 /*------------------------------------------------------------------------------
  *  				Pre-Processor Constants and Configurations
@@ -31,84 +35,147 @@
 #define LOCKSYSTEM 0x05
 #define NO_PEOPLE 0x06
 
-#define CPU_FREQ 8000000
 #define DOORTIME 15
 #define LOCKTIME 60
+
+#define PASS_LENGTH 5
+#define MAX_FAILS 3
+/*
+ * The EEPROM write cycle time, in milliseconds
+ */
+#define EEPROM_WRITE_TIME 10
+/*
+ * Deadlines given to the watchdog supervisor, in milliseconds: the door and lockout
+ * get their time plus a margin, the password bytes follow READY at once
+ */
+#define DEADLINE_MARGIN 1000
+#define EEPROM_DEADLINE 500
+#define PROTOCOL_DEADLINE 1000
+
+/*
+ * Scheduler events
+ */
+#define EVENT_UART_RX 0x0001
+#define EVENT_OPEN_DOOR 0x0002
+#define EVENT_PIR_CHANGED 0x0004
+#define EVENT_LOCK 0x0008
+
 /*
  * Driver configurations
  */
 UART_ConfigType UART_Configurations = {UART_8_BITS, UART_NO_PARITY, UART_ONE_STOP_BIT, UART_BAUD_9600};
 TWI_ConfigType TWI_Configurations = {EEPROM_ADDRESS, TWI_BIT_RATE_400KHZ};
-Timer_ConfigType Timer_Configurations = {0, 0, TIMER_timer2, F_CPU_256, MODE_normal};
 
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
 
+/*
+ * What the protocol task expects to receive next from the HMI
+ */
+typedef enum
+{
+	PROTO_WAIT_COMMAND, PROTO_WAIT_READY, PROTO_RECEIVE_PASS, PROTO_STORE_PASS
+}ProtocolStateType;
+
+/*
+ * What the next received password is used for
+ */
+typedef enum
+{
+	PASS_NEW, PASS_CONFIRM, PASS_CHECK
+}PassStageType;
+
+typedef enum
+{
+	DOOR_IDLE, DOOR_OPENING, DOOR_WAIT_PEOPLE, DOOR_CLOSING
+}DoorStateType;
 
 /*------------------------------------------------------------------------------
  *  				Global Variables and Function Declarations
  *----------------------------------------------------------------------------*/
 
 /*
- * This flag is used to indicate if a certain amount of ticks has been reached
- * In this codes case, 15 and 60 seconds
+ * Task IDs given by the scheduler
  */
-static uint8 g_flag = 0;
+static SCHED_TaskIdType g_protocolTask;
+static SCHED_TaskIdType g_doorTask;
+static SCHED_TaskIdType g_alarmTask;
 /*
- * Ticks of timers
+ * Array to store the password received from the HMI
  */
-static uint32 g_tick = 0;
+static uint8 Pass[PASS_LENGTH];
 /*
- * Array to store the password of
+ * The first entry of a new password, kept until it is confirmed
  */
-static uint8 Pass[5];
+static uint8 g_newPass[PASS_LENGTH];
 /*
- * Value read from the EEPROM when comparing passwords
+ * Number of password bytes received, or written to the EEPROM while storing
  */
-static uint8 EEPROM_val;
+static uint8 g_passIndex = 0;
 /*
  * This is used to indicate if the user has failed to enter the password
  */
 static uint8 fail_counter = 0;
 /*
- * Status variable to exit or stay in loop
+ * The command being verified by the password, OPENDOOR or CHANGEPASS
+ */
+static uint8 g_command;
+/*
+ * State of the protocol with the HMI, the system starts by asking for a new password
  */
-static uint8 status = 1;
+static ProtocolStateType g_protocolState = PROTO_WAIT_READY;
+static PassStageType g_passStage = PASS_NEW;
 /*
- * if timer is configuration overflow, use this in the call back, otherwise it is equal to ctc number
+ * State of the door, an open request that comes while the door is busy is kept pending
  */
-static uint32 timerMode_num;
+static DoorStateType g_doorState = DOOR_IDLE;
+static boolean g_doorOpenPending = FALSE;
+
+/*
+ * Task that samples the debounced inputs after every system tick
+ */
+void inputTask(void);
+
+/*
+ * Task that receives the bytes from the HMI and answers them
+ */
+void protocolTask(void);
+
 /*
- * take number of prescalar to use in timer equation
+ * Task that runs the door cycle: open, wait for the people to pass, close
  */
-static uint32 timerClock_num;
+void doorTask(void);
+
 /*
- * this variable calculates the amount of ticks needed to reach,
+ * Task that sounds the alarm if the user enters password wrong 3 times
  */
-static uint32 calc;
+void alarmTask(void);
 
 /*
- * Receive Password from the HMI MC
+ * Handle one byte received from the HMI
  */
-void recievePass(void);
+void protocolReceive(uint8 data);
 
 /*
- * Function to activate Motor, which resembles opening the door
+ * Called when all the password bytes are received
  */
-void openDoor();
+void passReceived(void);
 
 /*
- * Function to lock system if the user enters password wrong 3 times
+ * Write the next byte of the confirmed password in the EEPROM
  */
-void lockSystem();
+void storePass(void);
 
 /*
- * Function to recieve system password from the user for the first time, if returns 0 if both passworrds don't match, and 1 if they do
+ * Compare the received password with the EEPROM, returns 1 if they match
  */
-uint8 firstPass(void);
+uint8 checkPass(void);
 
 /*
- * Same as the firstPass function but different name
+ * Tell the HMI whether it needs to repeat the password
  */
-void changePass(void);
+void sendResult(uint8 result);
 
 /*
  * Compares the passwords, be aware that it compares bytes so you must have it in for loop to work
@@ -116,27 +183,31 @@ void changePass(void);
 uint8 comparePasswords(uint8 Val, uint8 Val2);
 
 /*
- * This is the call-back function for the timer driver
+ * This is the call-back function for the UART driver, called for every received byte
  */
-void timer_callBack(void)
+void uart_callBack(void)
 {
-	g_tick++;
-	if(g_tick == calc)
-	{
-		g_tick = 0;
-		g_flag = 1;
-	}
+	SCHED_setEvent(EVENT_UART_RX);
 }
+
 /*
- * This function is used to calculate the ticks needed for any prescalar, any mode and any timer
+ * This is the call-back function for the PIR, called from the input task every time its debounced output changes
  */
-void timerCalculations();
+void pir_callBack(void)
+{
+	SCHED_setEvent(EVENT_PIR_CHANGED);
+}
 
 /*------------------------------------------------------------------------------
  *  						Application Code
  *----------------------------------------------------------------------------*/
 int main() {
 
+	/*
+	 * Record a watchdog reset before anything else, the watchdog starts with its task
+	 */
+	WDG_init();
+
 	/*
 	 * Activate the global interrupt register
 	 */
@@ -149,162 +220,38 @@ int main() {
 	BUZZER_init();
 	TWI_init(&TWI_Configurations);
 	DcMotor_Init();
+	INPUT_init();
 	PIR_init();
 
 	/*
-	 * This first for loop is for the user entering the first password of the system, it will not break if the passwords are incorrect which
-	 * means it will keep looping forever
+	 * Start the millisecond time base used for timeouts and time stamps,
+	 * then the ISR and CPU load statistics that are measured with it
 	 */
-	for(;;)
-	{
-		/*
-		 * If status is one, meaning the passwords are matching, send to the other MC that there is no need to repeat
-		 * the process and we can move on to the main system
-		 */
-		if(firstPass())
-		{
-			UART_sendByte(READY);
-			_delay_ms(50);
-			UART_sendByte(NO_REPEAT);
-			break;
-		}
-		else
-		{
-			UART_sendByte(READY);
-			_delay_ms(50);
-			UART_sendByte(REPEAT);
-		}
-	}
+	Timer_startSystemClock();
+	PROFILER_init();
 
 	/*
-	 * This infinite for loop activates after the first Password, it stays on for as long as the system is on
-	 * if the byte received is + which indicates opening the door, it performs that code
-	 * else, it will be - which is changing the password
+	 * Start the time of day, it keeps counting while the CPU sleeps
 	 */
-	for(;;)
-	{
-		if(UART_recieveByte() == OPENDOOR)
-		{
-			/*
-			 * This block of code is used to compare the password received and the password stored in the EEPROM
-			 */
-			for(fail_counter = 0; fail_counter < 3; fail_counter++)
-			{
-				recievePass();
-				for(uint8 i = 0; i < 5; i++)
-				{
-					EEPROM_readByte(EEPROM_ADDRESS+i, &EEPROM_val);
-					_delay_ms(50);
-					if(comparePasswords(Pass[i], EEPROM_val))
-					{
-						/*
-						 * Break the loop since the bytes don't match and reset
-						 */
-						status = 0;
-						break;
-					}
-					else
-					{
-						status = 1;
-					}
-				}
+	RTC_init();
 
-				/*
-				 * If status is one, meaning the passwords are matching, send to the other MC that there is no need to repeat
-				 * the process and we can move on
-				 */
-				if(status)
-				{
-					UART_sendByte(READY);
-					_delay_ms(50);
-					UART_sendByte(NO_REPEAT);
-					break;
-				}
-				else
-				{
-					UART_sendByte(READY);
-					_delay_ms(50);
-					UART_sendByte(REPEAT);
-				}
-			}
-
-			if(fail_counter == 3)
-			{
-				/*
-				 * Lock system since failure to enter the correct password is 3
-				 */
-				lockSystem();
-			}
-			else
-			{
-				/*
-				 * The password is correct and therefore opening the door starts
-				 */
-				openDoor();
-			}
-		}
-
-		else
-		{
-			/*
-			 * This block of code is used to compare the password received and the password stored in the EEPROM
-			 */
-			for(fail_counter = 0; fail_counter < 3; fail_counter++)
-			{
-				recievePass();
-				for(uint8 i = 0; i < 5; i++)
-				{
-					EEPROM_readByte(EEPROM_ADDRESS+i, &EEPROM_val);
-					_delay_ms(50);
-					if(comparePasswords(Pass[i], EEPROM_val))
-					{
-						/*
-						 * Break the loop since the bytes don't match and reset
-						 */
-						status = 0;
-						break;
-					}
-					else
-					{
-						status = 1;
-					}
-				}
+	/*
+	 * The protocol, the door and the alarm run side by side as tasks,
+	 * each one waits on its events or wake up time instead of spinning. The system tick
+	 * only sets SCHED_EVENT_TICK, the input task is added first so it samples before
+	 * the other tasks run
+	 */
+	SCHED_init();
+	SCHED_addTask(inputTask, SCHED_EVENT_TICK);
+	g_protocolTask = SCHED_addTask(protocolTask, EVENT_UART_RX);
+	g_doorTask = SCHED_addTask(doorTask, EVENT_OPEN_DOOR | EVENT_PIR_CHANGED);
+	g_alarmTask = SCHED_addTask(alarmTask, EVENT_LOCK);
+	WDG_addTask();
 
-				/*
-				 * If status is one, meaning the passwords are matching, send to the other MC that there is no need to repeat
-				 * the process and we can move on
-				 */
-				if(status)
-				{
-					UART_sendByte(READY);
-					_delay_ms(50);
-					UART_sendByte(NO_REPEAT);
-					break;
-				}
-				else
-				{
-					UART_sendByte(READY);
-					_delay_ms(50);
-					UART_sendByte(REPEAT);
-				}
-			}
+	UART_setReceiveCallBack(uart_callBack);
+	PIR_setCallBack(pir_callBack);
 
-			if(fail_counter == 3)
-			{
-				/*
-				 * Lock system since failure to enter the correct password is 3
-				 */
-				lockSystem();
-			}
-			else
-			{
-				/*
-				 * The password is correct and therefore changing password starts
-				 */
-				changePass();
-			}
-		}
-	}
+	SCHED_run();
 }
 
 
@@ -324,199 +271,291 @@ uint8 comparePasswords(uint8 Val, uint8 Val2)
     return 0; // Passwords match
 }
 
-
-void recievePass(){
+void inputTask(void)
+{
 	/*
-	 * Wait for the HMI to be ready
+	 * Not at the first run, the inputs are sampled once per system tick
 	 */
-	while(UART_recieveByte() != READY);
-
-	for(uint8 i = 0; i < 5; i++)
+	if(SCHED_getEvents() & SCHED_EVENT_TICK)
 	{
-		_delay_ms(50);
-		Pass[i] = UART_recieveByte();
-		// Receive the password
+		INPUT_tick();
 	}
 }
 
-void openDoor()
+void protocolTask(void)
 {
-	timerCalculations();
-
-	_delay_ms(100);
-	calc = (DOORTIME*CPU_FREQ)/(timerMode_num * timerClock_num);
-	/*
-	 * Start the timer and set callback function
-	 */
-	g_tick = 0;
-	g_flag = 0;
-	Timer_setCallBack(timer_callBack, Timer_Configurations.timer_ID);
-	Timer_init(&Timer_Configurations);
-
-	/*
-	 * Rotate until the timer activates flag, which is in 15 seconds
-	 */
-	DcMotor_Rotate(CW, 255);
-	while(!g_flag);
-	DcMotor_Rotate(STOP, 255);
-
-	/*
-	 * Wait till people pass
-	 */
-	while(PIR_getValue())
-
-	_delay_ms(50);
+	uint8 data;
 
 	/*
-	 * Tell the HMI that people have passed and it is ready to close the door
+	 * While the password is being written, the received bytes wait in the UART buffer
 	 */
-	UART_sendByte(READY);
-
-	UART_sendByte(NO_PEOPLE);
-
-	g_flag = 0;
-	g_tick = 0;
+	if(g_protocolState == PROTO_STORE_PASS)
+	{
+		if(SCHED_getEvents() & SCHED_EVENT_TIMEOUT)
+		{
+			storePass();
+		}
+		return;
+	}
 
-	/*
-	 * Rotate anti-clockwise until the timer activates flag, which is in 15 seconds
-	 */
-	DcMotor_Rotate(ACW, 255);
-	while(!g_flag);
-	DcMotor_Rotate(STOP, 255);
-	Timer_deinit(Timer_Configurations.timer_ID);
+	while((g_protocolState != PROTO_STORE_PASS) && UART_tryReceiveByte(&data))
+	{
+		protocolReceive(data);
+	}
 }
 
-void lockSystem()
+void protocolReceive(uint8 data)
 {
-	timerCalculations();
-
-	_delay_ms(100);
-	calc = (LOCKTIME*CPU_FREQ)/(timerMode_num * timerClock_num);
-
-	/*
-	 * Activate buzzer alarm
-	 */
-	BUZZER_on();
-	/*
-	 * Start the timer and set callback function
-	 */
-
-	Timer_setCallBack(timer_callBack, Timer_Configurations.timer_ID);
-	Timer_init(&Timer_Configurations);
-	g_tick = 0;
-	g_flag = 0;
-	/*
-	 * Wait for timer to raise flag, 60 seconds
-	 */
-	while(!g_flag);
-
-	Timer_deinit(Timer_Configurations.timer_ID);
-	/*
-	 * deactivate buzzer alarm
-	 */
-	BUZZER_off();
+	switch(g_protocolState)
+	{
+	case PROTO_WAIT_COMMAND:
+		/*
+		 * Both commands are verified by the old password first
+		 */
+		if((data == OPENDOOR) || (data == CHANGEPASS))
+		{
+			g_command = data;
+			fail_counter = 0;
+			g_passStage = PASS_CHECK;
+			g_protocolState = PROTO_WAIT_READY;
+		}
+		break;
+	case PROTO_WAIT_READY:
+		/*
+		 * Wait for the HMI to be ready
+		 */
+		if(data == READY)
+		{
+			WDG_start(WDG_PROTOCOL, PROTOCOL_DEADLINE);
+			g_passIndex = 0;
+			g_protocolState = PROTO_RECEIVE_PASS;
+		}
+		break;
+	case PROTO_RECEIVE_PASS:
+		Pass[g_passIndex] = data;
+		g_passIndex++;
+		if(g_passIndex == PASS_LENGTH)
+		{
+			passReceived();
+		}
+		break;
+	case PROTO_STORE_PASS:
+		break;
+	}
 }
 
-uint8 firstPass(void)
+void passReceived(void)
 {
-	recievePass();
+	uint8 i;
 
-	/*
-	 * This following block of code is to receive and write the password in the eeprom
-	 * if incorrect, the for loop is exited and the process is reset
-	 */
-	while(UART_recieveByte() != READY);
+	WDG_done(WDG_PROTOCOL);
 
-	for(uint8 i = 0; i < 5; i++)
+	switch(g_passStage)
 	{
-		_delay_ms(50);
-		if(comparePasswords(Pass[i], UART_recieveByte()))
+	case PASS_NEW:
+		/*
+		 * Keep the first entry and wait for the user to enter it again
+		 */
+		for(i = 0; i < PASS_LENGTH; i++)
+		{
+			g_newPass[i] = Pass[i];
+		}
+		g_passStage = PASS_CONFIRM;
+		g_protocolState = PROTO_WAIT_READY;
+		break;
+	case PASS_CONFIRM:
+		for(i = 0; i < PASS_LENGTH; i++)
+		{
+			if(comparePasswords(Pass[i], g_newPass[i]))
+			{
+				break;
+			}
+		}
+
+		if(i == PASS_LENGTH)
+		{
+			/*
+			 * Both entries match, write them in the EEPROM then answer the HMI
+			 */
+			g_passIndex = 0;
+			g_protocolState = PROTO_STORE_PASS;
+			WDG_start(WDG_EEPROM, EEPROM_DEADLINE);
+			storePass();
+		}
+		else
 		{
 			/*
-			 * Break the loop since the bytes don't match and reset
+			 * The entries don't match so the whole process is repeated
 			 */
-			status = 0;
-			return status;
+			sendResult(REPEAT);
+			g_passStage = PASS_NEW;
+			g_protocolState = PROTO_WAIT_READY;
+		}
+		break;
+	case PASS_CHECK:
+		if(checkPass())
+		{
+			sendResult(NO_REPEAT);
+			if(g_command == OPENDOOR)
+			{
+				SCHED_setEvent(EVENT_OPEN_DOOR);
+				g_protocolState = PROTO_WAIT_COMMAND;
+			}
+			else
+			{
+				g_passStage = PASS_NEW;
+				g_protocolState = PROTO_WAIT_READY;
+			}
 		}
 		else
 		{
-			status = 1;
-			EEPROM_writeByte(EEPROM_ADDRESS+i,Pass[i]);
+			sendResult(REPEAT);
+			fail_counter++;
+			if(fail_counter == MAX_FAILS)
+			{
+				/*
+				 * Lock system since failure to enter the correct password is 3
+				 */
+				SCHED_setEvent(EVENT_LOCK);
+				g_protocolState = PROTO_WAIT_COMMAND;
+			}
+			else
+			{
+				g_protocolState = PROTO_WAIT_READY;
+			}
 		}
+		break;
 	}
-	return status;
 }
 
-void changePass()
+void storePass(void)
 {
-	/*
-	 * This infinite for loop is for the user entering the password of the system forever until it is correct
-	 */
-	for(;;)
+	EEPROM_writeByte(EEPROM_ADDRESS + g_passIndex, Pass[g_passIndex]);
+	g_passIndex++;
+
+	if(g_passIndex < PASS_LENGTH)
 	{
 		/*
-		 * If status is one, meaning the passwords are matching, send to the other MC that there is no need to repeat
-		 * the process and we can move on to the main system
+		 * Let the EEPROM finish its write cycle before the next byte
 		 */
-		if(firstPass())
-		{
-			UART_sendByte(READY);
-			_delay_ms(50);
-			UART_sendByte(NO_REPEAT);
-			break;
-		}
-		else
-		{
-			UART_sendByte(READY);
-			_delay_ms(50);
-			UART_sendByte(REPEAT);
-		}
+		SCHED_wakeAfter(g_protocolTask, EEPROM_WRITE_TIME);
+	}
+	else
+	{
+		WDG_done(WDG_EEPROM);
+		sendResult(NO_REPEAT);
+		g_protocolState = PROTO_WAIT_COMMAND;
+
+		/*
+		 * Handle the bytes that arrived while writing
+		 */
+		SCHED_setReady(g_protocolTask);
 	}
 }
 
-void timerCalculations()
+uint8 checkPass(void)
 {
-	timerMode_num = Timer_Configurations.timer_compare_MatchValue - Timer_Configurations.timer_InitialValue;
+	uint8 EEPROM_val;
 
-	if(Timer_Configurations.timer_mode == MODE_normal)
+	for(uint8 i = 0; i < PASS_LENGTH; i++)
 	{
-		if(Timer_Configurations.timer_ID == TIMER_timer1)
+		EEPROM_readByte(EEPROM_ADDRESS + i, &EEPROM_val);
+		if(comparePasswords(Pass[i], EEPROM_val))
 		{
-			timerMode_num = 65535 - Timer_Configurations.timer_InitialValue;
-		}
-		else
-		{
-			timerMode_num = 255 - Timer_Configurations.timer_InitialValue;
+			return 0;
 		}
 	}
+	return 1;
+}
 
-	_delay_ms(100);
+void sendResult(uint8 result)
+{
+	UART_sendByte(READY);
+	UART_sendByte(result);
+}
+
+void doorTask(void)
+{
+	SCHED_EventType events = SCHED_getEvents();
+
+	if(events & EVENT_OPEN_DOOR)
+	{
+		g_doorOpenPending = TRUE;
+	}
 
-	switch(Timer_Configurations.timer_clock)
+	/*
+	 * The door closed after 15 seconds
+	 */
+	if((g_doorState == DOOR_CLOSING) && (events & SCHED_EVENT_TIMEOUT))
 	{
-		case NO_CLOCK:
-			timerClock_num = 0;
-			break;
-		case F_CPU_CLOCK:
-			timerClock_num = 1;
-			break;
-		case F_CPU_8:
-			timerClock_num = 8;
-			break;
-		case F_CPU_32_T2:
-			timerClock_num = 32;
-			break;
-		case F_CPU_64:
-			timerClock_num = 64;
-			break;
-		case F_CPU_128_T2:
-			timerClock_num = 128;
-			break;
-		case F_CPU_256:
-			timerClock_num = 256;
-			break;
-		case F_CPU_1024:
-			timerClock_num = 1024;
-			break;
+		DcMotor_Rotate(STOP, 255);
+		g_doorState = DOOR_IDLE;
+		WDG_done(WDG_DOOR_CYCLE);
+	}
+	/*
+	 * The door opened after 15 seconds, now wait till people pass
+	 */
+	else if((g_doorState == DOOR_OPENING) && (events & SCHED_EVENT_TIMEOUT))
+	{
+		DcMotor_Rotate(STOP, 255);
+		g_doorState = DOOR_WAIT_PEOPLE;
+
+		/*
+		 * People may take any time to pass, the wait is not supervised
+		 */
+		WDG_done(WDG_DOOR_CYCLE);
+	}
+
+	if((g_doorState == DOOR_WAIT_PEOPLE) && (PIR_getValue() == LOGIC_LOW))
+	{
+		/*
+		 * Tell the HMI that people have passed and it is ready to close the door
+		 */
+		UART_sendByte(READY);
+		UART_sendByte(NO_PEOPLE);
+
+		/*
+		 * Rotate anti-clockwise for 15 seconds
+		 */
+		DcMotor_Rotate(ACW, 255);
+		g_doorState = DOOR_CLOSING;
+		SCHED_wakeAfter(g_doorTask, DOORTIME * 1000UL);
+		WDG_start(WDG_DOOR_CYCLE, (DOORTIME * 1000UL) + DEADLINE_MARGIN);
+	}
+
+	if((g_doorState == DOOR_IDLE) && g_doorOpenPending)
+	{
+		/*
+		 * Rotate clockwise for 15 seconds
+		 */
+		g_doorOpenPending = FALSE;
+		DcMotor_Rotate(CW, 255);
+		g_doorState = DOOR_OPENING;
+		SCHED_wakeAfter(g_doorTask, DOORTIME * 1000UL);
+		WDG_start(WDG_DOOR_CYCLE, (DOORTIME * 1000UL) + DEADLINE_MARGIN);
+	}
+}
+
+void alarmTask(void)
+{
+	SCHED_EventType events = SCHED_getEvents();
+
+	if(events & EVENT_LOCK)
+	{
+		/*
+		 * Activate buzzer alarm for 60 seconds
+		 */
+		BUZZER_on();
+		SCHED_wakeAfter(g_alarmTask, LOCKTIME * 1000UL);
+		WDG_start(WDG_LOCKOUT, (LOCKTIME * 1000UL) + DEADLINE_MARGIN);
+	}
+	else if(events & SCHED_EVENT_TIMEOUT)
+	{
+		/*
+		 * deactivate buzzer alarm
+		 */
+		BUZZER_off();
+		WDG_done(WDG_LOCKOUT);
 	}
 }
+
@@ -10,6 +10,7 @@
 
 
 #include "std_types.h"
+#include <avr/io.h> /* The pin descriptors resolve to the IO Registers */
 
 /*------------------------------------------------------------------------------
  *  				Pre-Processor Constants and Configurations
@@ -90,4 +91,111 @@ void GPIO_writePort(uint8 port_num, uint8 value);
  */
 uint8 GPIO_readPort(uint8 port_num);
 
+/*
+ * Description :
+ * Set up the DDR of the pins of a port selected by mask, all of them become
+ * outputs or inputs at the same time, the other pins are not changed.
+ * The register is read, changed and written with the interrupts disabled
+ * if an wrong value is given, the function will ignore
+ */
+void GPIO_setupPortDirectionMasked(uint8 port_num, uint8 mask, GPIO_PortDirectionType direction);
+
+/*
+ * Description :
+ * Write the bits of value to the pins of a port selected by mask at the same time,
+ * the other pins are not changed.
+ * The register is read, changed and written with the interrupts disabled
+ * if an wrong value is given, the function will ignore
+ */
+void GPIO_writePortMasked(uint8 port_num, uint8 mask, uint8 value);
+
+/*
+ * Description :
+ * Read the pins of a port selected by mask in one read, the other bits are returned as 0
+ * if wrong value given, the fucntion will return LOGIC_LOW
+ */
+uint8 GPIO_readPortMasked(uint8 port_num, uint8 mask);
+
+/*------------------------------------------------------------------------------
+ *  						Compile-Time Pin Descriptors
+ *----------------------------------------------------------------------------*/
+
+/*
+ * A pin descriptor is the port letter and the bit of a pin known at compile time:
+ *     #define LCD_E_PIN    C, 1
+ * The macros below resolve it to the DDRx/PORTx/PINx register, so every access
+ * is a single SBI/CBI/SBIC instruction instead of a call to the functions above.
+ * Counted from the generated instructions of the -O0 build, not measured on the target
+ * (cycles without the call and its arguments):
+ *     GPIO_writePin           106 - 151    GPIO_PIN_HIGH/GPIO_PIN_LOW     2
+ *     GPIO_readPin            111 - 147    GPIO_PIN_READ                  3
+ *     GPIO_setupPinDirection   92 - 151    GPIO_PIN_OUTPUT/GPIO_PIN_INPUT 2
+ * The port must be A, B, C or D and the bit 0 to 7, a wrong value does not compile.
+ */
+#define GPIO_PIN_OUTPUT(PIN)              GPIO_PIN_OUTPUT_(PIN)
+#define GPIO_PIN_INPUT(PIN)               GPIO_PIN_INPUT_(PIN)
+#define GPIO_PIN_HIGH(PIN)                GPIO_PIN_HIGH_(PIN)
+#define GPIO_PIN_LOW(PIN)                 GPIO_PIN_LOW_(PIN)
+#define GPIO_PIN_READ(PIN)                GPIO_PIN_READ_(PIN)
+
+/* Write LOGIC_HIGH or LOGIC_LOW, a constant value leaves only one instruction */
+#define GPIO_PIN_WRITE(PIN, VALUE)        do { if(VALUE) { GPIO_PIN_HIGH_(PIN); } else { GPIO_PIN_LOW_(PIN); } } while(0)
+
+/*
+ * A port descriptor is the port letter alone, for the drivers that select the
+ * bit at run time (the keypad), it gives the register to read or write directly
+ */
+#define GPIO_DDR(L)                       GPIO_CONCAT_(DDR, L)
+#define GPIO_PORT(L)                      GPIO_CONCAT_(PORT, L)
+#define GPIO_PIN(L)                       GPIO_CONCAT_(PIN, L)
+
+/*
+ * The port ID and the bit mask of a descriptor, to change pins of the same port
+ * together with the masked functions:
+ *     GPIO_writePortMasked(GPIO_PORT_ID(D), GPIO_PIN_MASK(MOTOR_IN1_PIN) | GPIO_PIN_MASK(MOTOR_IN2_PIN), ...)
+ */
+#define GPIO_PORT_ID(L)                   GPIO_CONCAT3_(PORT, L, _ID)
+#define GPIO_PIN_MASK(PIN)                GPIO_PIN_MASK_(PIN)
+
+/* The PORTx_ID and PINx_ID of a descriptor, for the functions that take them */
+#define GPIO_PIN_PORT_ID(PIN)             GPIO_PIN_PORT_ID_(PIN)
+#define GPIO_PIN_NUM(PIN)                 GPIO_BIT_(PIN)
+
+/* Expand the descriptors before they are split into their port and bit */
+#define GPIO_CONCAT_(REG, L)              REG##L
+#define GPIO_CONCAT3_(REG, L, ID)         REG##L##ID
+#define GPIO_PIN_MASK_(...)               ((uint8)(1 << GPIO_BIT_(__VA_ARGS__)))
+#define GPIO_PIN_PORT_ID_(...)            GPIO_PORT_ID_OF_(__VA_ARGS__)
+#define GPIO_PORT_ID_OF_(L, B)            PORT##L##_ID
+#define GPIO_PIN_OUTPUT_(...)             GPIO_SET_BIT_(GPIO_REG_DDR_(__VA_ARGS__), GPIO_BIT_(__VA_ARGS__))
+#define GPIO_PIN_INPUT_(...)              GPIO_CLEAR_BIT_(GPIO_REG_DDR_(__VA_ARGS__), GPIO_BIT_(__VA_ARGS__))
+#define GPIO_PIN_HIGH_(...)               GPIO_SET_BIT_(GPIO_REG_PORT_(__VA_ARGS__), GPIO_BIT_(__VA_ARGS__))
+#define GPIO_PIN_LOW_(...)                GPIO_CLEAR_BIT_(GPIO_REG_PORT_(__VA_ARGS__), GPIO_BIT_(__VA_ARGS__))
+#define GPIO_PIN_READ_(...)               GPIO_READ_BIT_(GPIO_REG_PIN_(__VA_ARGS__), GPIO_BIT_(__VA_ARGS__))
+#define GPIO_REG_DDR_(L, B)               DDR##L
+#define GPIO_REG_PORT_(L, B)              PORT##L
+#define GPIO_REG_PIN_(L, B)               PIN##L
+#define GPIO_BIT_(L, B)                   (B)
+
+#ifdef __AVR__
+/*
+ * -O0 does not turn a read-modify-write into SBI/CBI, so the instructions are
+ * written here. They are also atomic, no interrupt can split them
+ */
+#define GPIO_SET_BIT_(REG, BIT)           __asm__ __volatile__ ("sbi %0, %1" : : "I" (_SFR_IO_ADDR(REG)), "I" (BIT))
+#define GPIO_CLEAR_BIT_(REG, BIT)         __asm__ __volatile__ ("cbi %0, %1" : : "I" (_SFR_IO_ADDR(REG)), "I" (BIT))
+#define GPIO_READ_BIT_(REG, BIT)          __extension__ ({ uint8 value_;                        \
+                                              __asm__ __volatile__ ("ldi %0, 0"    "\n\t"     \
+                                                                    "sbic %1, %2" "\n\t"     \
+                                                                    "ldi %0, 1"                \
+                                                                    : "=d" (value_)            \
+                                                                    : "I" (_SFR_IO_ADDR(REG)), "I" (BIT)); \
+                                              value_; })
+#else
+/* Plain C for the host builds */
+#define GPIO_SET_BIT_(REG, BIT)           ((REG) |= (uint8)(1 << (BIT)))
+#define GPIO_CLEAR_BIT_(REG, BIT)         ((REG) &= (uint8)~(1 << (BIT)))
+#define GPIO_READ_BIT_(REG, BIT)          ((uint8)(((REG) >> (BIT)) & 1))
+#endif
+
 #endif /* GPIO_H_ */
@@ -0,0 +1,186 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Debounced Input Service
+ *  File        : input.c
+ *  Description : Source file for the digital inputs sampled and debounced on the system tick
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "input.h"
+#include "gpio.h"
+#include <avr/io.h> /* To use the SREG Register */
+#include <avr/interrupt.h> /* For cli */
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef struct {
+	void (*volatile callBack)(void);
+	uint8 port;          /* PORTx_ID of the pin */
+	uint8 mask;          /* Bit of the pin in its port */
+	uint8 integrator;    /* 0 - INPUT_DEBOUNCE_SAMPLES */
+	uint8 value;         /* Debounced value */
+	uint8 events;        /* INPUT_EVENT_ bits not read yet */
+} INPUT_PinType;
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Inputs sampled by the system tick, an input is filled before g_inputCount counts it
+ */
+static volatile INPUT_PinType g_inputs[INPUT_MAX_PINS];
+static volatile uint8 g_inputCount = 0;
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Remove all the inputs
+ */
+void INPUT_init(void)
+{
+	g_inputCount = 0;
+}
+
+/*
+ * Description:
+ * Set up the pin as an input and start sampling it, its value starts as the pin reads now.
+ * Returns the ID of the input or INPUT_INVALID
+ */
+INPUT_IdType INPUT_add(uint8 port_num, uint8 pin_num, boolean pullUp)
+{
+	INPUT_IdType id = g_inputCount;
+	volatile INPUT_PinType *input;
+
+	if((id >= INPUT_MAX_PINS) || (port_num >= NUM_OF_PORTS) || (pin_num >= NUM_OF_PINS_PER_PORT))
+	{
+		return INPUT_INVALID;
+	}
+
+	GPIO_setupPinDirection(port_num, pin_num, PIN_INPUT);
+	GPIO_writePin(port_num, pin_num, pullUp ? LOGIC_HIGH : LOGIC_LOW);
+
+	input = &g_inputs[id];
+	input->callBack = NULL_PTR;
+	input->port = port_num;
+	input->mask = 1 << pin_num;
+	input->value = GPIO_readPin(port_num, pin_num);
+	input->integrator = (input->value == LOGIC_HIGH) ? INPUT_DEBOUNCE_SAMPLES : 0;
+	input->events = 0;
+
+	/*
+	 * The tick samples the input from now on
+	 */
+	g_inputCount = id + 1;
+
+	return id;
+}
+
+/*
+ * Description:
+ * Set the function called from INPUT_tick every time the
+ * debounced value of the input changes, NULL_PTR for no call back
+ */
+void INPUT_setCallBack(void(*a_ptr)(void), INPUT_IdType a_input_ID)
+{
+	uint8 sreg = SREG;
+
+	/*
+	 * The pointer is two bytes, do not let the ISR see half of it
+	 */
+	cli();
+	g_inputs[a_input_ID].callBack = a_ptr;
+	SREG = sreg;
+}
+
+/*
+ * Description:
+ * Return the debounced value of the input, LOGIC_HIGH or LOGIC_LOW
+ */
+uint8 INPUT_getValue(INPUT_IdType a_input_ID)
+{
+	return g_inputs[a_input_ID].value;
+}
+
+/*
+ * Description:
+ * Return the INPUT_EVENT_ bits of the edges since the last call, then clear them
+ */
+uint8 INPUT_getEvents(INPUT_IdType a_input_ID)
+{
+	uint8 sreg = SREG;
+	uint8 events;
+
+	cli();
+	events = g_inputs[a_input_ID].events;
+	g_inputs[a_input_ID].events = 0;
+	SREG = sreg;
+
+	return events;
+}
+
+/*
+ * Description:
+ * Sample all the inputs, call it from a task after every system tick
+ * (a task waiting on SCHED_EVENT_TICK)
+ */
+void INPUT_tick(void)
+{
+#if (INPUT_SAMPLE_TICKS > 1)
+	static uint8 ticks = 0;
+#endif
+	volatile INPUT_PinType *input;
+	uint8 i;
+
+#if (INPUT_SAMPLE_TICKS > 1)
+	if(++ticks < INPUT_SAMPLE_TICKS)
+	{
+		return;
+	}
+	ticks = 0;
+#endif
+
+	for(i = 0; i < g_inputCount; i++)
+	{
+		input = &g_inputs[i];
+
+		if(GPIO_readPortMasked(input->port, input->mask))
+		{
+			if(input->integrator < INPUT_DEBOUNCE_SAMPLES)
+			{
+				input->integrator++;
+			}
+		}
+		else if(input->integrator > 0)
+		{
+			input->integrator--;
+		}
+
+		/*
+		 * The value changes only at the ends of the integrator, bounces in between are ignored
+		 */
+		if((input->integrator == INPUT_DEBOUNCE_SAMPLES) && (input->value == LOGIC_LOW))
+		{
+			input->value = LOGIC_HIGH;
+			input->events |= INPUT_EVENT_RISE;
+		}
+		else if((input->integrator == 0) && (input->value == LOGIC_HIGH))
+		{
+			input->value = LOGIC_LOW;
+			input->events |= INPUT_EVENT_FALL;
+		}
+		else
+		{
+			continue;
+		}
+
+		if(input->callBack != NULL_PTR)
+		{
+			(*input->callBack)();
+		}
+	}
+}
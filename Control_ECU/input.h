@@ -0,0 +1,88 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Debounced Input Service
+ *  File        : input.h
+ *  Description : Header file for the digital inputs sampled and debounced on the system tick
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef INPUT_H_
+#define INPUT_H_
+
+#include "std_types.h"
+#include "timer.h"
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/* Number of inputs that can be added */
+#define INPUT_MAX_PINS                    4
+
+/*
+ * The inputs are sampled every INPUT_SAMPLE_TICKS system ticks. Every input has an
+ * integrator that counts up on a high sample and down on a low one, its value changes
+ * when the integrator reaches INPUT_DEBOUNCE_SAMPLES or 0. A clean edge is reported
+ * INPUT_LATENCY_MS after it happens, a bouncing one when the bouncing stops.
+ * INPUT_tick runs in a task, the ticks that pass while another task runs count as one
+ */
+#define INPUT_SAMPLE_TICKS                1
+#define INPUT_DEBOUNCE_SAMPLES            3
+#define INPUT_LATENCY_MS                  (INPUT_SAMPLE_TICKS * INPUT_DEBOUNCE_SAMPLES * TIMER_SYSCLK_TICK_MS)
+
+/* Returned by INPUT_add when all the inputs are taken */
+#define INPUT_INVALID                     0xFF
+
+/* Events returned by INPUT_getEvents */
+#define INPUT_EVENT_RISE                  0x01
+#define INPUT_EVENT_FALL                  0x02
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef uint8 INPUT_IdType;
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Remove all the inputs
+ */
+void INPUT_init(void);
+
+/*
+ * Description:
+ * Set up the pin as an input and start sampling it, its value starts as the pin reads now.
+ * Returns the ID of the input or INPUT_INVALID
+ */
+INPUT_IdType INPUT_add(uint8 port_num, uint8 pin_num, boolean pullUp);
+
+/*
+ * Description:
+ * Set the function called from INPUT_tick every time the
+ * debounced value of the input changes, NULL_PTR for no call back
+ */
+void INPUT_setCallBack(void(*a_ptr)(void), INPUT_IdType a_input_ID);
+
+/*
+ * Description:
+ * Return the debounced value of the input, LOGIC_HIGH or LOGIC_LOW
+ */
+uint8 INPUT_getValue(INPUT_IdType a_input_ID);
+
+/*
+ * Description:
+ * Return the INPUT_EVENT_ bits of the edges since the last call, then clear them
+ */
+uint8 INPUT_getEvents(INPUT_IdType a_input_ID);
+
+/*
+ * Description:
+ * Sample all the inputs, call it from a task after every system tick
+ * (a task waiting on SCHED_EVENT_TICK)
+ */
+void INPUT_tick(void);
+
+#endif /* INPUT_H_ */
@@ -7,6 +7,7 @@
 
 #include "motor.h"
 #include "gpio.h"
+#include "pwm.h"
 #include "avr/io.h"
 
 /*------------------------------------------------------------------------------
@@ -22,15 +23,13 @@ void DcMotor_Init(void){
 	/*
 	 * Set up all ports to be output
 	 */
-	GPIO_setupPinDirection(MOTOR_PORT_ID, MOTOR_EN_PIN_ID, PIN_OUTPUT);
-	GPIO_setupPinDirection(MOTOR_PORT_ID, MOTOR_IN1_PIN_ID, PIN_OUTPUT);
-	GPIO_setupPinDirection(MOTOR_PORT_ID, MOTOR_IN2_PIN_ID, PIN_OUTPUT);
+	GPIO_PIN_OUTPUT(MOTOR_EN_PIN);
+	GPIO_setupPortDirectionMasked(GPIO_PORT_ID(MOTOR_IN_PORT), MOTOR_IN_MASK, PORT_OUTPUT);
 
 	/*
 	 * To make sure that Motor is turned off
 	 */
-	GPIO_writePin(MOTOR_PORT_ID, MOTOR_IN1_PIN_ID, LOGIC_LOW);
-	GPIO_writePin(MOTOR_PORT_ID, MOTOR_IN2_PIN_ID, LOGIC_LOW);
+	GPIO_writePortMasked(GPIO_PORT_ID(MOTOR_IN_PORT), MOTOR_IN_MASK, 0);
 }
 
 /*
@@ -41,18 +40,15 @@ void DcMotor_Rotate(DcMotor_State state, uint8 speed){
 	switch(state)
 	{
 	case 0:
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_IN1_PIN_ID, LOGIC_HIGH);
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_IN2_PIN_ID, LOGIC_LOW);
+		GPIO_writePortMasked(GPIO_PORT_ID(MOTOR_IN_PORT), MOTOR_IN_MASK, GPIO_PIN_MASK(MOTOR_IN1_PIN));
 		break;
 	case 1:
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_IN1_PIN_ID, LOGIC_LOW);
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_IN2_PIN_ID, LOGIC_HIGH);
+		GPIO_writePortMasked(GPIO_PORT_ID(MOTOR_IN_PORT), MOTOR_IN_MASK, GPIO_PIN_MASK(MOTOR_IN2_PIN));
 		break;
 	case 2:
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_IN1_PIN_ID, LOGIC_LOW);
-		GPIO_writePin(MOTOR_PORT_ID, MOTOR_IN2_PIN_ID, LOGIC_LOW);
+		GPIO_writePortMasked(GPIO_PORT_ID(MOTOR_IN_PORT), MOTOR_IN_MASK, 0);
 		break;
 	}
 
-	PWM_Timer0_Start(speed);
+	PWM_start(speed);
 }
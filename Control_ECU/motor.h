@@ -13,13 +13,14 @@
  * 					 Pre-Processor Constants and Configurations
  *----------------------------------------------------------------------------*/
 
-#define MOTOR_PORT_ID				PORTD_ID
-
-#define MOTOR_ENABLE_PORT_ID		PORTB_ID
-
-#define MOTOR_EN_PIN_ID				PIN3_ID
-#define MOTOR_IN1_PIN_ID			PIN6_ID
-#define MOTOR_IN2_PIN_ID			PIN7_ID
+/* Motor pin descriptors, the enable pin is the OC0 output of the PWM timer */
+#define MOTOR_EN_PIN				B, 3
+
+/* IN1 and IN2 are on the same port so the direction changes with one write */
+#define MOTOR_IN_PORT				D
+#define MOTOR_IN1_PIN				MOTOR_IN_PORT, 6
+#define MOTOR_IN2_PIN				MOTOR_IN_PORT, 7
+#define MOTOR_IN_MASK				(GPIO_PIN_MASK(MOTOR_IN1_PIN) | GPIO_PIN_MASK(MOTOR_IN2_PIN))
 
 /*------------------------------------------------------------------------------
  *  							Data Types Declarations
@@ -10,22 +10,35 @@
 #include "common_macros.h"
 #include "pir.h"
 
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+static INPUT_IdType g_pirInput = INPUT_INVALID;
+
 /*------------------------------------------------------------------------------
  *  							Function Definitions
  *----------------------------------------------------------------------------*/
 
 
 /* Description:
- * Initialize the PIR pin
+ * Add the PIR pin to the debounced input service, call INPUT_init before it
  */
 
 void PIR_init(void){
-	GPIO_setupPinDirection(PIR_PORT_ID, PIR_PIN_ID, PIN_INPUT);
+	g_pirInput = INPUT_add(GPIO_PIN_PORT_ID(PIR_PIN), GPIO_PIN_NUM(PIR_PIN), FALSE);
 }
 
 /* Description:
- * Read value of PIR pin
+ * Read the debounced value of the PIR pin
  */
 uint8 PIR_getValue(void){
-	return GPIO_readPin(PIR_PORT_ID ,PIR_PIN_ID);
+	return INPUT_getValue(g_pirInput);
+}
+
+/* Description:
+ * Set the function called from the system tick every time the debounced PIR value changes
+ */
+void PIR_setCallBack(void(*a_ptr)(void)){
+	INPUT_setCallBack(a_ptr, g_pirInput);
 }
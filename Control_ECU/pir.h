@@ -10,27 +10,36 @@
 #define PIR_H_
 
 #include "std_types.h"
+#include "input.h"
 
 /*------------------------------------------------------------------------------
  * 					 Pre-Processor Constants and Configurations
  *----------------------------------------------------------------------------*/
 
-#define PIR_PORT_ID					PORTC_ID
-#define PIR_PIN_ID					PIN2_ID
+/*
+ * The PIR output, sampled and debounced by the input service. It needs no interrupt,
+ * so it stays on PC2 as wired in the schematic
+ */
+#define PIR_PIN						C, 2
 
 /*------------------------------------------------------------------------------
  *  							Function Declarations
  *----------------------------------------------------------------------------*/
 
 /* Description:
- * Initialize the PIR pin
+ * Add the PIR pin to the debounced input service, call INPUT_init before it
  */
 void PIR_init(void);
 
 /* Description:
- * Read value of PIR pin
+ * Read the debounced value of the PIR pin
  */
 uint8 PIR_getValue(void);
 
+/* Description:
+ * Set the function called from the system tick every time the debounced PIR value changes
+ */
+void PIR_setCallBack(void(*a_ptr)(void));
+
 
 #endif /* PIR_H_ */
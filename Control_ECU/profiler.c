@@ -0,0 +1,203 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Profiler
+ *  File        : profiler.c
+ *  Description : Source file for the ISR cost, interrupt latency and CPU load profiler
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "profiler.h"
+#include "timer.h" /* For the system clock */
+#include "uart.h" /* To stream the statistics */
+#include <avr/io.h> /* To use the SREG Register */
+#include <avr/interrupt.h> /* For cli */
+#include <string.h> /* For memset */
+
+#ifdef PROFILER_ENABLED
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Statistics of the vectors and of the last CPU load window
+ */
+volatile PROFILER_StatsType g_profilerStats;
+
+/*
+ * System clock time the current window started and the idle time seen in it
+ */
+static uint32 g_windowStart = 0;
+static uint32 g_windowIdleUs = 0;
+
+/*------------------------------------------------------------------------------
+ *  							Private Functions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Send a number in decimal over the UART
+ */
+static void PROFILER_sendNumber(uint32 a_num)
+{
+	uint8 digits[11];
+	uint8 i = 0;
+
+	do
+	{
+		digits[i++] = '0' + (a_num % 10);
+		a_num /= 10;
+	} while(a_num != 0);
+
+	while(i > 0)
+	{
+		UART_sendByte(digits[--i]);
+	}
+}
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Clear all the statistics and start a new CPU load window
+ */
+void PROFILER_init(void)
+{
+	uint8 sreg = SREG;
+	uint8 *ptr = (uint8 *)&g_profilerStats;
+	uint16 i;
+
+	cli();
+	for(i = 0; i < sizeof(PROFILER_StatsType); i++)
+	{
+		ptr[i] = 0;
+	}
+	SREG = sreg;
+
+	g_windowStart = Timer_getMillis();
+	g_windowIdleUs = 0;
+}
+
+/*
+ * Description:
+ * Copy the statistics without being interrupted in the middle
+ */
+void PROFILER_getStats(PROFILER_StatsType *a_stats)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	*a_stats = *(PROFILER_StatsType *)&g_profilerStats;
+	SREG = sreg;
+}
+
+/*
+ * Description:
+ * Add idle time seen by the scheduler, the CPU load is updated at the end of every window.
+ * The window is closed on the first idle pass after it ends, so a window where the
+ * CPU never became idle is closed late with a load near 100%
+ */
+void PROFILER_addIdleTime(uint32 a_us)
+{
+	uint32 elapsed_ms;
+	uint32 idlePercent;
+
+	g_windowIdleUs += a_us;
+
+	elapsed_ms = Timer_getMillis() - g_windowStart;
+	if(elapsed_ms < PROFILER_WINDOW_MS)
+	{
+		return;
+	}
+
+	/*
+	 * elapsed_ms * 10 is one percent of the window in microseconds
+	 */
+	idlePercent = g_windowIdleUs / (elapsed_ms * 10);
+	if(idlePercent > 100)
+	{
+		idlePercent = 100;
+	}
+
+	g_profilerStats.idleUs = g_windowIdleUs;
+	g_profilerStats.cpuLoad = 100 - idlePercent;
+	if(g_profilerStats.cpuLoad > g_profilerStats.maxCpuLoad)
+	{
+		g_profilerStats.maxCpuLoad = g_profilerStats.cpuLoad;
+	}
+
+	g_windowStart += elapsed_ms;
+	g_windowIdleUs = 0;
+
+#ifdef PROFILER_UART_STREAM
+	PROFILER_sendStats();
+#endif
+}
+
+/*
+ * Description:
+ * Send the statistics as one text line per vector over the UART:
+ * "CPU <load>% max <maxLoad>% idle <idleUs>us" then
+ * "V<vector> n <count> avg <cycles> max <cycles> lat <cycles>" for the vectors that ran
+ */
+void PROFILER_sendStats(void)
+{
+	PROFILER_StatsType stats;
+	uint8 v;
+
+	PROFILER_getStats(&stats);
+
+	UART_sendString((const uint8 *)"CPU ");
+	PROFILER_sendNumber(stats.cpuLoad);
+	UART_sendString((const uint8 *)"% max ");
+	PROFILER_sendNumber(stats.maxCpuLoad);
+	UART_sendString((const uint8 *)"% idle ");
+	PROFILER_sendNumber(stats.idleUs);
+	UART_sendString((const uint8 *)"us\r\n");
+
+	for(v = 0; v < PROFILER_NUM_VECTORS; v++)
+	{
+		if(stats.vector[v].count == 0)
+		{
+			continue;
+		}
+
+		UART_sendByte('V');
+		PROFILER_sendNumber(v);
+		UART_sendString((const uint8 *)" n ");
+		PROFILER_sendNumber(stats.vector[v].count);
+		UART_sendString((const uint8 *)" avg ");
+		PROFILER_sendNumber(stats.vector[v].totalCycles / stats.vector[v].count);
+		UART_sendString((const uint8 *)" max ");
+		PROFILER_sendNumber(stats.vector[v].maxCycles);
+		UART_sendString((const uint8 *)" lat ");
+		PROFILER_sendNumber(stats.vector[v].maxLatency);
+		UART_sendString((const uint8 *)"\r\n");
+	}
+}
+
+#else
+
+void PROFILER_init(void)
+{
+}
+
+void PROFILER_getStats(PROFILER_StatsType *a_stats)
+{
+	/*
+	 * Nothing is counted, the caller reads empty statistics
+	 */
+	memset(a_stats, 0, sizeof(*a_stats));
+}
+
+void PROFILER_addIdleTime(uint32 a_us)
+{
+	(void)a_us;
+}
+
+void PROFILER_sendStats(void)
+{
+}
+
+#endif /* PROFILER_ENABLED */
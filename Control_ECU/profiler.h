@@ -0,0 +1,184 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Profiler
+ *  File        : profiler.h
+ *  Description : Header file for the ISR cost, interrupt latency and CPU load profiler
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "std_types.h"
+#include "timer.h" /* For the system clock TCNT1 range */
+#include <avr/io.h> /* To use TCNT1 */
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Uncomment, or build with -DPROFILER_ENABLED, to add the profiler. It is off by default
+ * since it adds its bookkeeping to every ISR and a Timer_getMicros call to every pass
+ * of the scheduler, the ISR macros then expand to nothing
+ */
+/* #define PROFILER_ENABLED */
+
+/*
+ * Uncomment to send the statistics as text over the UART every window.
+ * The UART is the link between the two ECUs, only enable it while the
+ * UART is connected to a PC terminal instead of the other ECU
+ */
+/* #define PROFILER_UART_STREAM */
+
+/* CPU load is calculated over windows of this many milliseconds */
+#define PROFILER_WINDOW_MS                1000
+
+/* CPU cycles in one TCNT1 count of the system clock (F_CPU/8) */
+#define PROFILER_CYCLES_PER_COUNT         8
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef enum
+{
+	PROFILER_INT0,
+	PROFILER_INT1,
+	PROFILER_INT2,
+	PROFILER_TIMER0_OVF,
+	PROFILER_TIMER0_COMP,
+	PROFILER_TIMER1_OVF,
+	PROFILER_TIMER1_CAPT,
+	PROFILER_TIMER1_COMPA,
+	PROFILER_TIMER2_OVF,
+	PROFILER_TIMER2_COMP,
+	PROFILER_USART_RXC,
+	PROFILER_NUM_VECTORS
+}PROFILER_VectorType;
+
+typedef struct {
+	uint32 count;        /* Number of times the ISR was entered */
+	uint32 totalCycles;  /* Sum of the entry to exit cycles of all entries */
+	uint32 maxCycles;    /* Longest entry to exit time */
+	uint32 maxLatency;   /* Longest time from the interrupt event to the ISR entry, in cycles */
+} PROFILER_VectorStatsType;
+
+typedef struct {
+	PROFILER_VectorStatsType vector[PROFILER_NUM_VECTORS];
+	uint32 idleUs;       /* Time the scheduler found no ready task in the last window */
+	uint8 cpuLoad;       /* Percent of the last window spent in tasks and interrupts */
+	uint8 maxCpuLoad;    /* Highest cpuLoad since PROFILER_init */
+} PROFILER_StatsType;
+
+/*------------------------------------------------------------------------------
+ *  							Inline Functions and Macros
+ *----------------------------------------------------------------------------*/
+
+#ifdef PROFILER_ENABLED
+
+/*
+ * Statistics updated by the ISRs, read them through PROFILER_getStats
+ */
+extern volatile PROFILER_StatsType g_profilerStats;
+
+/*
+ * Description:
+ * Add one ISR run that started at TCNT1 = a_entry, called at the end of the ISR.
+ * Always inlined so the ISR does not make a call (see TIMERx_<vector>_HANDLER)
+ */
+static inline __attribute__((always_inline)) void PROFILER_isrExit(PROFILER_VectorType a_vector, uint16 a_entry)
+{
+	uint16 now = TCNT1;
+	uint32 cycles;
+
+	/*
+	 * TCNT1 goes back to 0 after TIMER_SYSCLK_TOP
+	 */
+	if(now < a_entry)
+	{
+		now += (TIMER_SYSCLK_TOP + 1);
+	}
+
+	/*
+	 * Counted in 32 bits, 16 bits of cycles overflow after 8ms
+	 */
+	cycles = (uint32)(uint16)(now - a_entry) * PROFILER_CYCLES_PER_COUNT;
+
+	g_profilerStats.vector[a_vector].count++;
+	g_profilerStats.vector[a_vector].totalCycles += cycles;
+	if(cycles > g_profilerStats.vector[a_vector].maxCycles)
+	{
+		g_profilerStats.vector[a_vector].maxCycles = cycles;
+	}
+}
+
+/*
+ * Description:
+ * Add the latency of a vector whose event time is known, a_counts is the number of
+ * TCNT1 counts from the event to the ISR entry
+ */
+static inline __attribute__((always_inline)) void PROFILER_isrLatency(PROFILER_VectorType a_vector, uint16 a_counts)
+{
+	uint32 cycles = (uint32)a_counts * PROFILER_CYCLES_PER_COUNT;
+
+	if(cycles > g_profilerStats.vector[a_vector].maxLatency)
+	{
+		g_profilerStats.vector[a_vector].maxLatency = cycles;
+	}
+}
+
+/*
+ * Put PROFILER_ISR_ENTER first and PROFILER_ISR_EXIT last in an ISR to count its cost.
+ * PROFILER_ISR_LATENCY can follow PROFILER_ISR_ENTER in the system clock vector,
+ * TCNT1 starts from 0 at the compare match so its value at entry is the latency
+ */
+#define PROFILER_ISR_ENTER(VECTOR)        uint16 profiler_entry = TCNT1
+#define PROFILER_ISR_EXIT(VECTOR)         PROFILER_isrExit((VECTOR), profiler_entry)
+#define PROFILER_ISR_LATENCY(VECTOR)      PROFILER_isrLatency((VECTOR), profiler_entry)
+
+/*
+ * Put PROFILER_IDLE_BEGIN at the start of the scheduler loop and PROFILER_IDLE_END
+ * where the loop found no ready task
+ */
+#define PROFILER_IDLE_BEGIN()             uint32 profiler_idleStart = Timer_getMicros()
+#define PROFILER_IDLE_END()               PROFILER_addIdleTime(Timer_getMicros() - profiler_idleStart)
+
+#else
+
+#define PROFILER_ISR_ENTER(VECTOR)
+#define PROFILER_ISR_EXIT(VECTOR)
+#define PROFILER_ISR_LATENCY(VECTOR)
+#define PROFILER_IDLE_BEGIN()
+#define PROFILER_IDLE_END()
+
+#endif /* PROFILER_ENABLED */
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Clear all the statistics and start a new CPU load window
+ */
+void PROFILER_init(void);
+
+/*
+ * Description:
+ * Copy the statistics without being interrupted in the middle
+ */
+void PROFILER_getStats(PROFILER_StatsType *a_stats);
+
+/*
+ * Description:
+ * Add idle time seen by the scheduler, the CPU load is updated at the end of every window
+ */
+void PROFILER_addIdleTime(uint32 a_us);
+
+/*
+ * Description:
+ * Send the statistics as one text line per vector over the UART
+ */
+void PROFILER_sendStats(void);
+
+#endif /* PROFILER_H_ */
@@ -11,28 +11,28 @@
 
 #include "pwm.h"
 
-#include "common_macros.h"
-#include "avr/io.h"
-#include "gpio.h"
+#include "timer.h"
 
-/* Description:
- * Initialize timer0 and start the timer
- * depending on the duty cycle a wave will be given that will be displayed on an Oscillator
+/*
+ * The timer is set up on the first call only, after that only the duty cycle
+ * changes so the wave does not restart
  */
-void PWM_Timer0_Start(uint8 duty_cycle){
-
-	TCNT0 = 0; // Set initial value
-
-	OCR0 = duty_cycle; // Set compare value
+static boolean g_pwmStarted = FALSE;
 
-	// GPIO_setupPinDirection(PWM_PORT_ID, PWM_PIN_ID, PIN_OUTPUT);
-
-	DDRB  = DDRB | (1<<PB3);
-	/*
-	 * FOC0 = 0 to activate PWM mode
-	 * WGM01 = 1 & WGM00 = 1 to activate fast PWM
-	 * COM01 = 1 & COM00 = 0  to activate NON-INVERTING mode
-	 * CS02 = 0 & CS01 = 1 & CS00 = 1 to activate 64 Prescalar
-	 */
-	TCCR0 = (1 << WGM01) | (1 << WGM00) | (1 << COM01) | (1 << CS01) |  (1 << CS00);
+/* Description:
+ * Start the fast non-inverting PWM on PWM_TIMER, or change the duty cycle
+ * if it is already running (0 - 255)
+ */
+void PWM_start(uint8 duty_cycle){
+
+	Timer_ConfigType PWM_Configurations = {0, duty_cycle, PWM_TIMER, PWM_CLOCK, MODE_fastPWM, PWM_CHANNEL, TIMER_OUTPUT_CLEAR};
+
+	if(g_pwmStarted)
+	{
+		Timer_setCompareValue(PWM_TIMER, PWM_CHANNEL, duty_cycle);
+	}
+	else
+	{
+		g_pwmStarted = Timer_init(&PWM_Configurations, TIMER_OWNER_PWM);
+	}
 }
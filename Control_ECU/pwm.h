@@ -9,23 +9,37 @@
 #define PWM_H_
 
 #include "std_types.h"
+#include "timer.h"
 
 /*------------------------------------------------------------------------------
  * 					 Pre-Processor Constants and Configurations
  *----------------------------------------------------------------------------*/
 
-#define PWM_PORT_ID						PORTB_ID
-#define PWM_PIN_ID						PIN3_ID
+/*
+ * Timer and channel giving the PWM, the wave is on the output pin of the channel
+ * (OC0 PB3, OC1A PD5, OC1B PD4, OC2 PD7). PWM_TIMER_NUM is the timer number
+ * in the allocation table of timer.h, the timer must be given to TIMER_OWNER_PWM
+ */
+#define PWM_TIMER_NUM					0
+#define PWM_TIMER						((Timer_ID_Type)PWM_TIMER_NUM)
+#define PWM_CHANNEL						TIMER_CHANNEL_A
+
+/* F_CPU/64 gives 8MHz/64/256 = ~490Hz */
+#define PWM_CLOCK						F_CPU_64
+
+#if (TIMER_OWNER_OF(PWM_TIMER_NUM) != TIMER_OWNER_PWM)
+#error "The PWM timer is not given to TIMER_OWNER_PWM in the timer allocation table"
+#endif
 
 /*------------------------------------------------------------------------------
  *  							Function Declarations
  *----------------------------------------------------------------------------*/
 
 /* Description:
- * Initialize timer0 and start the timer
- * depending on the duty cycle a wave will be given that will be displayed on an Oscillator
+ * Start the fast non-inverting PWM on PWM_TIMER, or change the duty cycle
+ * if it is already running (0 - 255)
  */
-void PWM_Timer0_Start(uint8 duty_cycle);
+void PWM_start(uint8 duty_cycle);
 
 
 #endif /* PWM_H_ */
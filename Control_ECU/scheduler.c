@@ -0,0 +1,317 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Scheduler
+ *  File        : scheduler.c
+ *  Description : Source file for the cooperative run-to-completion scheduler
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "scheduler.h"
+#include "timer.h" /* For the system clock */
+#include "profiler.h" /* To measure the idle time */
+#include "common_macros.h" /* To use the macros like SET_BIT */
+#include <avr/io.h> /* To use the SREG Register */
+#include <avr/interrupt.h> /* For cli */
+
+#if (SCHED_MAX_TASKS > 8)
+#error "The ready mask has one byte, SCHED_MAX_TASKS must not exceed 8"
+#endif
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef struct {
+	void (*task)(void);          /* Function called when the task is ready */
+	SCHED_EventType waitEvents;  /* Events that make the task ready */
+	SCHED_EventType events;      /* Events received since the task last ran */
+	uint32 wakeTime;             /* System clock time for SCHED_EVENT_TIMEOUT */
+	boolean wakeArmed;           /* TRUE while wakeTime is waited for */
+} SCHED_TaskType;
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Table of tasks, the index is the task ID and the priority (0 is the highest)
+ */
+static SCHED_TaskType g_tasks[SCHED_MAX_TASKS];
+
+/*
+ * Number of tasks added
+ */
+static uint8 g_taskCount = 0;
+
+/*
+ * Ready queue, bit i is set while task i is waiting to run
+ */
+static volatile uint8 g_readyMask = 0;
+
+/*
+ * Events set (possibly from interrupts) and not given to the tasks yet
+ */
+volatile SCHED_EventType g_schedPendingEvents = 0;
+
+/*
+ * Events that made the running task ready
+ */
+static SCHED_EventType g_currentEvents = 0;
+
+/*
+ * Function called when no task is ready
+ */
+static void (*g_idleHookPtr)(uint32 a_ms) = NULL_PTR;
+
+/*
+ * Task being run, not cleared by a reset so the watchdog supervisor can tell
+ * which task was running when the watchdog reset the CPU
+ */
+static volatile SCHED_TaskIdType g_runningTask __attribute__((section(".noinit")));
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Remove all tasks, pending events and wake up times
+ */
+void SCHED_init(void)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	g_taskCount = 0;
+	g_readyMask = 0;
+	g_schedPendingEvents = 0;
+	g_currentEvents = 0;
+	SREG = sreg;
+}
+
+/*
+ * Description:
+ * Add a task that is called every time it becomes ready, it must return quickly
+ * a_events is the mask of events that make the task ready when they are set.
+ * Tasks added first have the higher priority.
+ * Returns the ID of the task or SCHED_INVALID_TASK
+ */
+SCHED_TaskIdType SCHED_addTask(void (*a_task)(void), SCHED_EventType a_events)
+{
+	SCHED_TaskIdType id;
+
+	if((g_taskCount >= SCHED_MAX_TASKS) || (a_task == NULL_PTR))
+	{
+		return SCHED_INVALID_TASK;
+	}
+
+	id = g_taskCount;
+	g_tasks[id].task = a_task;
+	g_tasks[id].waitEvents = a_events | SCHED_EVENT_TIMEOUT;
+	g_tasks[id].events = 0;
+	g_tasks[id].wakeArmed = FALSE;
+	g_taskCount++;
+
+	/*
+	 * Every task runs once at the start to set itself up
+	 */
+	SCHED_setReady(id);
+
+	return id;
+}
+
+/*
+ * Description:
+ * Make the task ready to run once more, safe to call from interrupts
+ */
+void SCHED_setReady(SCHED_TaskIdType a_task_ID)
+{
+	uint8 sreg = SREG;
+
+	if(a_task_ID < g_taskCount)
+	{
+		cli();
+		SET_BIT(g_readyMask, a_task_ID);
+		SREG = sreg;
+	}
+}
+
+/*
+ * Description:
+ * Make the task ready with SCHED_EVENT_TIMEOUT after a_ms milliseconds,
+ * a new call replaces the old wake up time
+ */
+void SCHED_wakeAfter(SCHED_TaskIdType a_task_ID, uint32 a_ms)
+{
+	if(a_task_ID < g_taskCount)
+	{
+		g_tasks[a_task_ID].wakeTime = Timer_getMillis() + a_ms;
+		g_tasks[a_task_ID].wakeArmed = TRUE;
+	}
+}
+
+/*
+ * Description:
+ * Cancel the wake up time of the task if it was not reached yet
+ */
+void SCHED_cancelWake(SCHED_TaskIdType a_task_ID)
+{
+	if(a_task_ID < g_taskCount)
+	{
+		g_tasks[a_task_ID].wakeArmed = FALSE;
+	}
+}
+
+/*
+ * Description:
+ * Set events, every task waiting on any of them becomes ready, safe to call from interrupts
+ */
+void SCHED_setEvent(SCHED_EventType a_events)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	g_schedPendingEvents |= a_events;
+	SREG = sreg;
+}
+
+/*
+ * Description:
+ * Return the events that made the running task ready, they are cleared before it runs again
+ */
+SCHED_EventType SCHED_getEvents(void)
+{
+	return g_currentEvents;
+}
+
+/*
+ * Description:
+ * Return the ID of the running task or SCHED_INVALID_TASK between tasks.
+ * Before SCHED_run starts it is the task that was running at the last reset
+ */
+SCHED_TaskIdType SCHED_getRunningTask(void)
+{
+	return g_runningTask;
+}
+
+/*
+ * Description:
+ * Set the function called when no task is ready, NULL_PTR for none. a_ms is the time
+ * to the nearest wake up time or SCHED_NO_WAKE. It is called with the interrupts
+ * disabled after checking that nothing is ready, to sleep it must enable them with
+ * sei() right before sleep_cpu() so an interrupt that comes in between still wakes
+ * the CPU, and it must return with the interrupts enabled
+ */
+void SCHED_setIdleHook(void (*a_ptr)(uint32 a_ms))
+{
+	g_idleHookPtr = a_ptr;
+}
+
+/*
+ * Description:
+ * Run the ready tasks forever, this function never returns
+ */
+void SCHED_run(void)
+{
+	SCHED_EventType events;
+	uint32 now;
+	uint32 nextWake;
+	uint32 remaining;
+	uint8 sreg;
+	uint8 id;
+
+	g_runningTask = SCHED_INVALID_TASK;
+
+	for(;;)
+	{
+		PROFILER_IDLE_BEGIN();
+
+		/*
+		 * Take the events set by the interrupts and wake up the tasks waiting on them
+		 */
+		sreg = SREG;
+		cli();
+		events = g_schedPendingEvents;
+		g_schedPendingEvents = 0;
+		SREG = sreg;
+
+		now = Timer_getMillis();
+
+		for(id = 0; id < g_taskCount; id++)
+		{
+			if(g_tasks[id].wakeArmed && ((sint32)(now - g_tasks[id].wakeTime) >= 0))
+			{
+				g_tasks[id].wakeArmed = FALSE;
+				g_tasks[id].events |= SCHED_EVENT_TIMEOUT;
+				SCHED_setReady(id);
+			}
+
+			if(events & g_tasks[id].waitEvents)
+			{
+				g_tasks[id].events |= (events & g_tasks[id].waitEvents);
+				SCHED_setReady(id);
+			}
+		}
+
+		/*
+		 * Run the ready task with the highest priority only, then look at the
+		 * events again so a higher priority task is not kept waiting
+		 */
+		for(id = 0; id < g_taskCount; id++)
+		{
+			if(BIT_IS_SET(g_readyMask, id))
+			{
+				sreg = SREG;
+				cli();
+				CLEAR_BIT(g_readyMask, id);
+				SREG = sreg;
+
+				g_currentEvents = g_tasks[id].events;
+				g_tasks[id].events = 0;
+				g_runningTask = id;
+				(*g_tasks[id].task)();
+				g_runningTask = SCHED_INVALID_TASK;
+				g_currentEvents = 0;
+				break;
+			}
+		}
+
+		/*
+		 * No task was ready, this pass of the loop was idle time
+		 */
+		if(id == g_taskCount)
+		{
+			if(g_idleHookPtr != NULL_PTR)
+			{
+				nextWake = SCHED_NO_WAKE;
+				for(id = 0; id < g_taskCount; id++)
+				{
+					if(g_tasks[id].wakeArmed)
+					{
+						remaining = g_tasks[id].wakeTime - Timer_getMillis();
+						if((sint32)remaining < 0)
+						{
+							remaining = 0;
+						}
+						if(remaining < nextWake)
+						{
+							nextWake = remaining;
+						}
+					}
+				}
+
+				/*
+				 * An interrupt may have made a task ready since the check above,
+				 * look again with the interrupts disabled until the hook enables them
+				 */
+				sreg = SREG;
+				cli();
+				if((g_readyMask == 0) && (g_schedPendingEvents == 0))
+				{
+					(*g_idleHookPtr)(nextWake);
+				}
+				SREG = sreg;
+			}
+			PROFILER_IDLE_END();
+		}
+	}
+}
@@ -8,6 +8,60 @@
 #include "uart.h"
 #include "avr/io.h" /* To use the UART Registers */
 #include "common_macros.h" /* To use the macros like SET_BIT */
+#include <avr/interrupt.h> /* For the RX ISR */
+#include "profiler.h" /* To measure the RX ISR */
+
+#if ((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0)
+#error "UART_RX_BUFFER_SIZE must be a power of two"
+#endif
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Ring buffer of the received bytes, the ISR writes at the head and the
+ * application reads from the tail
+ */
+static volatile uint8 g_rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxTail = 0;
+
+/*
+ * Pointer to the function called after every received byte
+ */
+static void (*volatile g_rxCallBackPtr)(void) = NULL_PTR;
+
+/*
+ * Set by the first byte sent, before it TXC is clear although nothing is being sent
+ */
+static boolean g_txStarted = FALSE;
+
+/*------------------------------------------------------------------------------
+ *  							Interrupt Service Routines
+ *----------------------------------------------------------------------------*/
+
+ISR(USART_RXC_vect)
+{
+	PROFILER_ISR_ENTER(PROFILER_USART_RXC);
+	uint8 next = (g_rxHead + 1) & (UART_RX_BUFFER_SIZE - 1);
+
+	/*
+	 * Reading UDR clears the RXC flag, the byte is dropped if the buffer is full
+	 */
+	uint8 data = UDR;
+	if(next != g_rxTail)
+	{
+		g_rxBuffer[g_rxHead] = data;
+		g_rxHead = next;
+	}
+
+	if(g_rxCallBackPtr != NULL_PTR)
+	{
+		(*g_rxCallBackPtr)();
+	}
+	PROFILER_ISR_EXIT(PROFILER_USART_RXC);
+}
 
 /*------------------------------------------------------------------------------
  *  							Function Definitions
@@ -28,8 +82,11 @@ void UART_init(const UART_ConfigType * Config_Ptr)
     /* U2X = 1 for double transmission speed */
     UCSRA = (1<<U2X);
 
-    /* Enable Receiver and Transmitter */
-    UCSRB = (1<<RXEN) | (1<<TXEN);
+    /* Enable Receiver, Transmitter and the RX Complete interrupt */
+    UCSRB = (1<<RXEN) | (1<<TXEN) | (1<<RXCIE);
+    g_rxHead = 0;
+    g_rxTail = 0;
+    g_txStarted = FALSE;
 
     /* UCSRC settings - URSEL must be 1 to write to UCSRC */
     UCSRC = (1<<URSEL);
@@ -96,6 +153,13 @@ void UART_sendByte(const uint8 data)
 	 */
 	while(BIT_IS_CLEAR(UCSRA,UDRE)){}
 
+	/*
+	 * Clear TXC by writing 1 to it, it is set again when this byte and the ones
+	 * after it are all sent
+	 */
+	UCSRA = (1<<U2X) | (1<<TXC);
+	g_txStarted = TRUE;
+
 	/*
 	 * Put the required data in the UDR register and it also clear the UDRE flag as
 	 * the UDR register is not empty now
@@ -103,20 +167,63 @@ void UART_sendByte(const uint8 data)
 	UDR = data;
 }
 
+/*
+ * Description :
+ * Return TRUE when the last byte given to UART_sendByte has left the shift register.
+ * The sleep modes that stop the clock cut a byte still being sent
+ */
+boolean UART_isSendComplete(void)
+{
+	return (!g_txStarted) || BIT_IS_SET(UCSRA,TXC);
+}
+
 /*
  * Description :
  * Functional responsible for receive byte from another UART device.
  */
 uint8 UART_recieveByte(void)
 {
-	/* RXC flag is set when the UART receive data so wait until this flag is set to one */
-	while(BIT_IS_CLEAR(UCSRA,RXC)){}
+	uint8 data;
+
+	/* The RX interrupt puts every received byte in the buffer so wait until there is one */
+	while(!UART_tryReceiveByte(&data)){}
+
+    return data;
+}
+
+/*
+ * Description :
+ * Take a byte from the receive buffer without waiting.
+ * Returns FALSE if no byte was received yet
+ */
+boolean UART_tryReceiveByte(uint8 *data)
+{
+	if(g_rxTail == g_rxHead)
+	{
+		return FALSE;
+	}
 
 	/*
-	 * Read the received data from the Rx buffer (UDR)
-	 * The RXC flag will be cleared after read the data
+	 * Only the application moves the tail, the ISR only reads it
 	 */
-    return UDR;		
+	*data = g_rxBuffer[g_rxTail];
+	g_rxTail = (g_rxTail + 1) & (UART_RX_BUFFER_SIZE - 1);
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Set the function called from the RX interrupt after every received byte
+ */
+void UART_setReceiveCallBack(void(*a_ptr)(void))
+{
+	uint8 sreg = SREG;
+
+	/* The pointer is two bytes, do not let the ISR see half of it */
+	cli();
+	g_rxCallBackPtr = a_ptr;
+	SREG = sreg;
 }
 
 /*
@@ -10,6 +10,13 @@
 
 #include "std_types.h"
 
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/* Size of the receive buffer filled by the RX interrupt, must be a power of two */
+#define UART_RX_BUFFER_SIZE               16
+
 /*------------------------------------------------------------------------------
  *  							Data Types Declarations
  *----------------------------------------------------------------------------*/
@@ -68,12 +75,33 @@ void UART_init(const UART_ConfigType *Config_Ptr);
  */
 void UART_sendByte(const uint8 data);
 
+/*
+ * Description :
+ * Return TRUE when the last byte given to UART_sendByte has left the shift register.
+ * The sleep modes that stop the clock cut a byte still being sent
+ */
+boolean UART_isSendComplete(void);
+
 /*
  * Description :
  * Functional responsible for receive byte from another UART device.
+ * Waits until a byte is in the receive buffer
  */
 uint8 UART_recieveByte(void);
 
+/*
+ * Description :
+ * Take a byte from the receive buffer without waiting.
+ * Returns FALSE if no byte was received yet
+ */
+boolean UART_tryReceiveByte(uint8 *data);
+
+/*
+ * Description :
+ * Set the function called from the RX interrupt after every received byte
+ */
+void UART_setReceiveCallBack(void(*a_ptr)(void));
+
 /*
  * Description :
  * Send the required string through UART to the other UART device.
@@ -0,0 +1,212 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Watchdog Supervisor
+ *  File        : watchdog.c
+ *  Description : Source file for the watchdog supervisor with deadline monitoring
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "watchdog.h"
+#include "rtc.h" /* To time stamp the records */
+#include "timer.h" /* For the system clock */
+#include <avr/io.h> /* To use the MCUCSR Register */
+#include <avr/interrupt.h> /* For cli */
+#include <avr/wdt.h> /* For the watchdog timer */
+#include <avr/eeprom.h> /* To keep the record in the internal EEPROM */
+
+/* Written before a reset made on purpose, so WDG_init does not record it again as a hang */
+#define WDG_FORCED_RESET_MAGIC            0xA5
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef struct {
+	uint32 deadline;         /* System clock time the activity must finish by */
+	SCHED_TaskIdType owner;  /* Task that started the activity */
+	boolean armed;           /* TRUE while the activity is supervised */
+} WDG_DeadlineType;
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+static WDG_RecordType EEMEM g_wdgRecord;
+
+static WDG_DeadlineType g_deadlines[WDG_NUM_ACTIVITIES];
+
+static SCHED_TaskIdType g_wdgTask = SCHED_INVALID_TASK;
+
+/*
+ * Kept through the watchdog reset: the forced reset mark and the last
+ * time the supervisor task ran, which is the time stamp of a hang
+ */
+static uint8 g_forcedReset __attribute__((section(".noinit")));
+static uint32 g_lastAlive __attribute__((section(".noinit")));
+
+/*------------------------------------------------------------------------------
+ *  							Private Functions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Add one to a counter in the EEPROM, it stays at 255 once it gets there
+ */
+static void WDG_countUp(uint8 *a_counter)
+{
+	uint8 count = eeprom_read_byte(a_counter);
+
+	if(count != 0xFF)
+	{
+		eeprom_update_byte(a_counter, count + 1);
+	}
+}
+
+/*
+ * Description:
+ * Write the reason of a reset in the EEPROM record
+ */
+static void WDG_record(uint8 a_reason, uint8 a_activity, SCHED_TaskIdType a_task, uint32 a_timestamp)
+{
+	WDG_countUp(&g_wdgRecord.resets);
+	eeprom_update_byte(&g_wdgRecord.reason, a_reason);
+	eeprom_update_byte(&g_wdgRecord.activity, a_activity);
+	eeprom_update_byte(&g_wdgRecord.task, a_task);
+	eeprom_update_block(&a_timestamp, &g_wdgRecord.timestamp, sizeof(a_timestamp));
+
+	if(a_activity < WDG_NUM_ACTIVITIES)
+	{
+		WDG_countUp(&g_wdgRecord.misses[a_activity]);
+	}
+	else if(a_task < SCHED_MAX_TASKS)
+	{
+		WDG_countUp(&g_wdgRecord.hangs[a_task]);
+	}
+}
+
+/*
+ * Description:
+ * Record the activity that missed its deadline then let the watchdog reset the CPU
+ */
+static void WDG_reset(WDG_ActivityType a_activity)
+{
+	WDG_record(WDG_REASON_DEADLINE, a_activity, g_deadlines[a_activity].owner, RTC_getTimestamp());
+	g_forcedReset = WDG_FORCED_RESET_MAGIC;
+
+	cli();
+	wdt_enable(WDTO_15MS);
+	for(;;);
+}
+
+/*
+ * Description:
+ * Supervisor task, feeds the watchdog only while all the deadlines are met
+ */
+static void WDG_task(void)
+{
+	uint32 now = Timer_getMillis();
+	uint8 i;
+
+	for(i = 0; i < WDG_NUM_ACTIVITIES; i++)
+	{
+		if(g_deadlines[i].armed && ((sint32)(now - g_deadlines[i].deadline) >= 0))
+		{
+			WDG_reset(i);
+		}
+	}
+
+	g_lastAlive = RTC_getTimestamp();
+	wdt_reset();
+
+	SCHED_wakeAfter(g_wdgTask, WDG_CHECK_TIME);
+}
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Record a reset caused by the watchdog, call it first in main
+ * before SCHED_run so the task that was running at the reset is still known
+ */
+void WDG_init(void)
+{
+	uint8 i;
+
+	/*
+	 * An erased EEPROM reads 0xFF, the record starts from zero
+	 */
+	if(eeprom_read_byte(&g_wdgRecord.reason) == 0xFF)
+	{
+		WDG_clearRecord();
+	}
+
+	/*
+	 * A watchdog reset that was not made on purpose is a task that did not return
+	 */
+	if((MCUCSR & (1 << WDRF)) && (g_forcedReset != WDG_FORCED_RESET_MAGIC))
+	{
+		WDG_record(WDG_REASON_HANG, WDG_NO_ACTIVITY, SCHED_getRunningTask(), g_lastAlive);
+	}
+	MCUCSR &= ~(1 << WDRF);
+	g_forcedReset = 0;
+	g_lastAlive = 0;
+
+	for(i = 0; i < WDG_NUM_ACTIVITIES; i++)
+	{
+		g_deadlines[i].armed = FALSE;
+	}
+}
+
+/*
+ * Description:
+ * Add the supervisor task and start the watchdog, it must be added after all
+ * the other tasks so it has the lowest priority and also sees a starved scheduler.
+ * The watchdog starts here so slow start up (the RTC crystal) is not supervised
+ */
+void WDG_addTask(void)
+{
+	g_wdgTask = SCHED_addTask(WDG_task, 0);
+	wdt_enable(WDG_TIMEOUT);
+}
+
+/*
+ * Description:
+ * Give the activity a_budget_ms milliseconds to finish, the running task is its owner.
+ * A new call replaces the old deadline of the activity
+ */
+void WDG_start(WDG_ActivityType a_activity, uint32 a_budget_ms)
+{
+	g_deadlines[a_activity].deadline = Timer_getMillis() + a_budget_ms;
+	g_deadlines[a_activity].owner = SCHED_getRunningTask();
+	g_deadlines[a_activity].armed = TRUE;
+}
+
+/*
+ * Description:
+ * The activity has finished, it is not supervised anymore
+ */
+void WDG_done(WDG_ActivityType a_activity)
+{
+	g_deadlines[a_activity].armed = FALSE;
+}
+
+/*
+ * Description:
+ * Read the record kept in the EEPROM
+ */
+void WDG_getRecord(WDG_RecordType *a_record)
+{
+	eeprom_read_block(a_record, &g_wdgRecord, sizeof(WDG_RecordType));
+}
+
+/*
+ * Description:
+ * Clear the record kept in the EEPROM
+ */
+void WDG_clearRecord(void)
+{
+	WDG_RecordType record = {0, WDG_REASON_NONE, WDG_NO_ACTIVITY, SCHED_INVALID_TASK, 0, {0}, {0}};
+
+	eeprom_update_block(&record, &g_wdgRecord, sizeof(WDG_RecordType));
+}
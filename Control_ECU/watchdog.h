@@ -0,0 +1,106 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Watchdog Supervisor
+ *  File        : watchdog.h
+ *  Description : Header file for the watchdog supervisor with deadline monitoring
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef WATCHDOG_H_
+#define WATCHDOG_H_
+
+#include "std_types.h"
+#include "scheduler.h"
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * The supervisor task feeds the hardware watchdog every WDG_CHECK_TIME milliseconds,
+ * a task that keeps the CPU for longer than the watchdog timeout resets it
+ */
+#define WDG_CHECK_TIME                    100
+#define WDG_TIMEOUT                       WDTO_500MS
+
+/* Reasons of the last reset kept in the EEPROM record */
+#define WDG_REASON_NONE                   0
+#define WDG_REASON_DEADLINE               1 /* An activity missed its deadline */
+#define WDG_REASON_HANG                   2 /* The watchdog was not fed in time */
+
+/* Activity of a record when the reset was not caused by a deadline */
+#define WDG_NO_ACTIVITY                   0xFF
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Long running activities that are given a deadline
+ */
+typedef enum
+{
+	WDG_DOOR_CYCLE,
+	WDG_LOCKOUT,
+	WDG_EEPROM,
+	WDG_PROTOCOL,
+	WDG_NUM_ACTIVITIES
+}WDG_ActivityType;
+
+/*
+ * What is kept in the internal EEPROM about the watchdog resets
+ */
+typedef struct {
+	uint8 resets;                         /* Number of resets caused by the supervisor */
+	uint8 reason;                         /* WDG_REASON_ of the last reset */
+	uint8 activity;                       /* WDG_ActivityType of the last reset or WDG_NO_ACTIVITY */
+	uint8 task;                           /* Scheduler task that stalled or SCHED_INVALID_TASK */
+	uint32 timestamp;                     /* RTC time stamp of the last reset */
+	uint8 misses[WDG_NUM_ACTIVITIES];     /* Deadlines missed by each activity */
+	uint8 hangs[SCHED_MAX_TASKS];         /* Watchdog resets while each task was running */
+} WDG_RecordType;
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Record a reset caused by the watchdog, call it first in main
+ * before SCHED_run so the task that was running at the reset is still known
+ */
+void WDG_init(void);
+
+/*
+ * Description:
+ * Add the supervisor task and start the watchdog, it must be added after all
+ * the other tasks so it has the lowest priority and also sees a starved scheduler.
+ * The watchdog starts here so slow start up (the RTC crystal) is not supervised
+ */
+void WDG_addTask(void);
+
+/*
+ * Description:
+ * Give the activity a_budget_ms milliseconds to finish, the running task is its owner.
+ * A new call replaces the old deadline of the activity
+ */
+void WDG_start(WDG_ActivityType a_activity, uint32 a_budget_ms);
+
+/*
+ * Description:
+ * The activity has finished, it is not supervised anymore
+ */
+void WDG_done(WDG_ActivityType a_activity);
+
+/*
+ * Description:
+ * Read the record kept in the EEPROM
+ */
+void WDG_getRecord(WDG_RecordType *a_record);
+
+/*
+ * Description:
+ * Clear the record kept in the EEPROM
+ */
+void WDG_clearRecord(void);
+
+#endif /* WATCHDOG_H_ */
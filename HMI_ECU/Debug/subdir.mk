@@ -4,26 +4,38 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../exti.c \
 ../gpio.c \
 ../hmi.c \
 ../keypad.c \
 ../lcd.c \
+../profiler.c \
+../rtc.c \
+../scheduler.c \
 ../timer.c \
 ../uart.c 
 
 OBJS += \
+./exti.o \
 ./gpio.o \
 ./hmi.o \
 ./keypad.o \
 ./lcd.o \
+./profiler.o \
+./rtc.o \
+./scheduler.o \
 ./timer.o \
 ./uart.o 
 
 C_DEPS += \
+./exti.d \
 ./gpio.d \
 ./hmi.d \
 ./keypad.d \
 ./lcd.d \
+./profiler.d \
+./rtc.d \
+./scheduler.d \
 ./timer.d \
 ./uart.d 
 
@@ -0,0 +1,224 @@
+/*------------------------------------------------------------------------------
+ *  Module      : External Interrupt Driver
+ *  File        : exti.c
+ *  Description : Source file for the ATmega32 external interrupts INT0, INT1 and INT2
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "exti.h"
+#include "common_macros.h" /* To use the macros like SET_BIT */
+#include "gpio.h" /* For the interrupt pins */
+#include <avr/io.h> /* To use the External Interrupts Registers */
+#include <avr/interrupt.h> /* For the INTx ISRs */
+#include "profiler.h" /* To measure the ISRs */
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Call back of each interrupt, the pointers themselves are volatile since the ISRs read them
+ */
+static void (*volatile g_callBackPtr[EXTI_NUM_INTERRUPTS])(void) = {NULL_PTR, NULL_PTR, NULL_PTR};
+
+/*
+ * One bit for each interrupt, set by its ISR and cleared by EXTI_getEvent
+ */
+static volatile uint8 g_events = 0;
+
+/*------------------------------------------------------------------------------
+ *  							Interrupt Service Routines
+ *----------------------------------------------------------------------------*/
+
+ISR(INT0_vect)
+{
+	PROFILER_ISR_ENTER(PROFILER_INT0);
+	g_events |= (1 << EXTI_INT0);
+	if(g_callBackPtr[EXTI_INT0] != NULL_PTR)
+	{
+		(*g_callBackPtr[EXTI_INT0])();
+	}
+	PROFILER_ISR_EXIT(PROFILER_INT0);
+}
+
+ISR(INT1_vect)
+{
+	PROFILER_ISR_ENTER(PROFILER_INT1);
+	g_events |= (1 << EXTI_INT1);
+	if(g_callBackPtr[EXTI_INT1] != NULL_PTR)
+	{
+		(*g_callBackPtr[EXTI_INT1])();
+	}
+	PROFILER_ISR_EXIT(PROFILER_INT1);
+}
+
+ISR(INT2_vect)
+{
+	PROFILER_ISR_ENTER(PROFILER_INT2);
+	g_events |= (1 << EXTI_INT2);
+	if(g_callBackPtr[EXTI_INT2] != NULL_PTR)
+	{
+		(*g_callBackPtr[EXTI_INT2])();
+	}
+	PROFILER_ISR_EXIT(PROFILER_INT2);
+}
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Set up the pin and the sense of the interrupt then enable it, an event that
+ * was pending from before is cleared.
+ * Returns FALSE if the sense is not supported by the interrupt
+ */
+boolean EXTI_init(const EXTI_ConfigType *Config_Ptr)
+{
+	uint8 sreg;
+
+	if((Config_Ptr->exti_ID == EXTI_INT2) &&
+	   ((Config_Ptr->exti_sense == EXTI_LOW_LEVEL) || (Config_Ptr->exti_sense == EXTI_ANY_CHANGE)))
+	{
+		return FALSE;
+	}
+
+	/*
+	 * The interrupt stays disabled while its sense changes, changing the sense can set its flag
+	 */
+	EXTI_deinit(Config_Ptr->exti_ID);
+
+	sreg = SREG;
+	cli();
+	switch(Config_Ptr->exti_ID)
+	{
+	case EXTI_INT0:
+		GPIO_PIN_INPUT(EXTI_INT0_PIN);
+		GPIO_PIN_WRITE(EXTI_INT0_PIN, Config_Ptr->exti_pullUp);
+		MCUCR = (MCUCR & ~((1 << ISC01) | (1 << ISC00))) | (Config_Ptr->exti_sense << ISC00);
+		break;
+	case EXTI_INT1:
+		GPIO_PIN_INPUT(EXTI_INT1_PIN);
+		GPIO_PIN_WRITE(EXTI_INT1_PIN, Config_Ptr->exti_pullUp);
+		MCUCR = (MCUCR & ~((1 << ISC11) | (1 << ISC10))) | (Config_Ptr->exti_sense << ISC10);
+		break;
+	case EXTI_INT2:
+		GPIO_PIN_INPUT(EXTI_INT2_PIN);
+		GPIO_PIN_WRITE(EXTI_INT2_PIN, Config_Ptr->exti_pullUp);
+		if(Config_Ptr->exti_sense == EXTI_RISING_EDGE)
+		{
+			SET_BIT(MCUCSR, ISC2);
+		}
+		else
+		{
+			CLEAR_BIT(MCUCSR, ISC2);
+		}
+		break;
+	}
+	SREG = sreg;
+
+	EXTI_clearEvent(Config_Ptr->exti_ID);
+
+	sreg = SREG;
+	cli();
+	switch(Config_Ptr->exti_ID)
+	{
+	case EXTI_INT0:
+		SET_BIT(GICR, INT0);
+		break;
+	case EXTI_INT1:
+		SET_BIT(GICR, INT1);
+		break;
+	case EXTI_INT2:
+		SET_BIT(GICR, INT2);
+		break;
+	}
+	SREG = sreg;
+
+	return TRUE;
+}
+
+/*
+ * Description:
+ * Disable the interrupt, its pin stays an input
+ */
+void EXTI_deinit(EXTI_ID_Type a_exti_ID)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	switch(a_exti_ID)
+	{
+	case EXTI_INT0:
+		CLEAR_BIT(GICR, INT0);
+		break;
+	case EXTI_INT1:
+		CLEAR_BIT(GICR, INT1);
+		break;
+	case EXTI_INT2:
+		CLEAR_BIT(GICR, INT2);
+		break;
+	}
+	SREG = sreg;
+}
+
+/*
+ * Description:
+ * Set the function called from the ISR each time the interrupt happens,
+ * NULL_PTR for no call back
+ */
+void EXTI_setCallBack(void(*a_ptr)(void), EXTI_ID_Type a_exti_ID)
+{
+	uint8 sreg = SREG;
+
+	/*
+	 * The pointer is two bytes, do not let the ISR see half of it
+	 */
+	cli();
+	g_callBackPtr[a_exti_ID] = a_ptr;
+	SREG = sreg;
+}
+
+/*
+ * Description:
+ * Return TRUE once if the interrupt happened since the last call or EXTI_clearEvent,
+ * for the users that do not set a call back
+ */
+boolean EXTI_getEvent(EXTI_ID_Type a_exti_ID)
+{
+	uint8 sreg = SREG;
+	boolean event;
+
+	cli();
+	event = BIT_IS_SET(g_events, a_exti_ID) ? TRUE : FALSE;
+	CLEAR_BIT(g_events, a_exti_ID);
+	SREG = sreg;
+
+	return event;
+}
+
+/*
+ * Description:
+ * Forget the events that happened so far, also the one pending in the hardware
+ * flag if the interrupt could not run yet
+ */
+void EXTI_clearEvent(EXTI_ID_Type a_exti_ID)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	switch(a_exti_ID)
+	{
+	case EXTI_INT0:
+		GIFR = (1 << INTF0); /* The flag is cleared by writing one to it */
+		break;
+	case EXTI_INT1:
+		GIFR = (1 << INTF1);
+		break;
+	case EXTI_INT2:
+		GIFR = (1 << INTF2);
+		break;
+	}
+	CLEAR_BIT(g_events, a_exti_ID);
+	SREG = sreg;
+}
@@ -0,0 +1,96 @@
+/*------------------------------------------------------------------------------
+ *  Module      : External Interrupt Driver
+ *  File        : exti.h
+ *  Description : Header file for the ATmega32 external interrupts INT0, INT1 and INT2
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef EXTI_H_
+#define EXTI_H_
+
+#include "std_types.h"
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/* Number of external interrupts */
+#define EXTI_NUM_INTERRUPTS               3
+
+/*
+ * Pins of the external interrupts, they are set up as inputs by EXTI_init
+ */
+#define EXTI_INT0_PIN                     D, 2
+#define EXTI_INT1_PIN                     D, 3
+#define EXTI_INT2_PIN                     B, 2
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef enum
+{
+	EXTI_INT0,
+	EXTI_INT1,
+	EXTI_INT2
+}EXTI_ID_Type;
+
+/*
+ * What makes the interrupt, the values are the ISC bits of INT0/INT1.
+ * INT2 supports the falling and the rising edges only
+ */
+typedef enum
+{
+	EXTI_LOW_LEVEL,
+	EXTI_ANY_CHANGE,
+	EXTI_FALLING_EDGE,
+	EXTI_RISING_EDGE
+}EXTI_SenseType;
+
+typedef struct
+{
+	EXTI_ID_Type exti_ID;
+	EXTI_SenseType exti_sense;
+	boolean exti_pullUp;      /* TRUE turns on the internal pull up of the pin */
+}EXTI_ConfigType;
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Set up the pin and the sense of the interrupt then enable it, an event that
+ * was pending from before is cleared.
+ * Returns FALSE if the sense is not supported by the interrupt
+ */
+boolean EXTI_init(const EXTI_ConfigType *Config_Ptr);
+
+/*
+ * Description:
+ * Disable the interrupt, its pin stays an input
+ */
+void EXTI_deinit(EXTI_ID_Type a_exti_ID);
+
+/*
+ * Description:
+ * Set the function called from the ISR each time the interrupt happens,
+ * NULL_PTR for no call back
+ */
+void EXTI_setCallBack(void(*a_ptr)(void), EXTI_ID_Type a_exti_ID);
+
+/*
+ * Description:
+ * Return TRUE once if the interrupt happened since the last call or EXTI_clearEvent,
+ * for the users that do not set a call back
+ */
+boolean EXTI_getEvent(EXTI_ID_Type a_exti_ID);
+
+/*
+ * Description:
+ * Forget the events that happened so far, also the one pending in the hardware
+ * flag if the interrupt could not run yet
+ */
+void EXTI_clearEvent(EXTI_ID_Type a_exti_ID);
+
+#endif /* EXTI_H_ */
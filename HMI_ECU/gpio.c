@@ -8,6 +8,7 @@
 #include "gpio.h"
 #include "common_macros.h" /* To use the macros like SET_BIT */
 #include "avr/io.h" /* To use the IO Ports Registers */
+#include <avr/interrupt.h> /* For cli */
 
 /*------------------------------------------------------------------------------
  *  							Function Definitions
@@ -323,3 +324,89 @@ uint8 GPIO_readPort(uint8 port_num)
 
 	return value;
 }
+
+/*
+ * Description :
+ * Set up the DDR of the pins of a port selected by mask, all of them become
+ * outputs or inputs at the same time, the other pins are not changed.
+ * The register is read, changed and written with the interrupts disabled
+ * if an wrong value is given, the function will ignore
+ */
+void GPIO_setupPortDirectionMasked(uint8 port_num, uint8 mask, GPIO_PortDirectionType direction)
+{
+	uint8 sreg;
+
+	if(port_num >= NUM_OF_PORTS)
+	{
+		/* Ignore */
+	}
+	else
+	{
+		sreg = SREG;
+		cli();
+		switch(port_num)
+		{
+		case PORTA_ID:
+			DDRA = (DDRA & ~mask) | (direction & mask);
+			break;
+		case PORTB_ID:
+			DDRB = (DDRB & ~mask) | (direction & mask);
+			break;
+		case PORTC_ID:
+			DDRC = (DDRC & ~mask) | (direction & mask);
+			break;
+		case PORTD_ID:
+			DDRD = (DDRD & ~mask) | (direction & mask);
+			break;
+		}
+		SREG = sreg;
+	}
+}
+
+/*
+ * Description :
+ * Write the bits of value to the pins of a port selected by mask at the same time,
+ * the other pins are not changed.
+ * The register is read, changed and written with the interrupts disabled
+ * if an wrong value is given, the function will ignore
+ */
+void GPIO_writePortMasked(uint8 port_num, uint8 mask, uint8 value)
+{
+	uint8 sreg;
+
+	if(port_num >= NUM_OF_PORTS)
+	{
+		/* Ignore */
+	}
+	else
+	{
+		sreg = SREG;
+		cli();
+		switch(port_num)
+		{
+		case PORTA_ID:
+			PORTA = (PORTA & ~mask) | (value & mask);
+			break;
+		case PORTB_ID:
+			PORTB = (PORTB & ~mask) | (value & mask);
+			break;
+		case PORTC_ID:
+			PORTC = (PORTC & ~mask) | (value & mask);
+			break;
+		case PORTD_ID:
+			PORTD = (PORTD & ~mask) | (value & mask);
+			break;
+		}
+		SREG = sreg;
+	}
+}
+
+/*
+ * Description :
+ * Read the pins of a port selected by mask in one read, the other bits are returned as 0
+ * if wrong value given, the fucntion will return LOGIC_LOW
+ */
+uint8 GPIO_readPortMasked(uint8 port_num, uint8 mask)
+{
+	return GPIO_readPort(port_num) & mask;
+}
@@ -7,6 +7,9 @@
 
 
 #include "lcd.h"
+#include "profiler.h"
+#include "rtc.h"
+#include "scheduler.h"
 #include "timer.h"
 #include "uart.h"
 #include "keypad.h"
@@ -14,7 +17,9 @@
 #include "common_macros.h"
 #include "std_types.h"
 #include "avr/io.h"
-#include "util/delay.h"
+#include <avr/interrupt.h> /* For sei */
+#include <avr/sleep.h> /* For the idle and power-save modes */
+#include <avr/pgmspace.h> /* For PSTR, the texts of the screens stay in flash */
 
 /*------------------------------------------------------------------------------
  *  				Pre-Processor Constants and Configurations
@@ -28,89 +33,148 @@
 #define LOCKSYSTEM 0x05
 #define NO_PEOPLE 0x06
 
-#define CPU_FREQ 8000000
 #define DOORTIME 15
 #define LOCKTIME 60
+
+#define PASS_LENGTH 5
+#define MAX_FAILS 3
+/*
+ * Time the project name is shown in milliseconds
+ */
+#define SPLASH_TIME 2000
+
+/*
+ * Scheduler events
+ */
+#define EVENT_UART_RX 0x0001
+#define EVENT_KEY 0x0002
+
 /*
  * Driver configurations
  */
 UART_ConfigType UART_Configurations = {UART_8_BITS, UART_NO_PARITY, UART_ONE_STOP_BIT, UART_BAUD_9600};
-Timer_ConfigType Timer_Configurations = {0, 0, TIMER_timer2, F_CPU_256, MODE_normal};
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Screen shown to the user and what it waits for
+ */
+typedef enum
+{
+	UI_SPLASH, UI_MENU, UI_ENTER_PASS, UI_WAIT_RESULT,
+	UI_DOOR_OPENING, UI_WAIT_PEOPLE, UI_DOOR_CLOSING, UI_LOCKED
+}UiStateType;
+
+/*
+ * What the password being entered is used for
+ */
+typedef enum
+{
+	PASS_NEW, PASS_CONFIRM, PASS_CHECK
+}PassStageType;
 
 /*------------------------------------------------------------------------------
  *  				Global Variables and Function Declarations
  *----------------------------------------------------------------------------*/
 
+/*
+ * Task IDs given by the scheduler
+ */
+static SCHED_TaskIdType g_uiTask;
+static SCHED_TaskIdType g_lcdTask;
 /*
  * This is used to indicate if the user has failed to enter the password
  */
 static uint8 fail_counter = 0;
 /*
- * This variable is to store the keypad number
+ * This variable is to store the keypad number taken from the keypad queue
  */
-static uint8 g_key = 100;
+static uint8 g_key = KEYPAD_NO_KEY;
 /*
  * Store Password
  */
-static uint8 g_arrKey[5];
+static uint8 g_arrKey[PASS_LENGTH];
+/*
+ * Number of digits entered of the password
+ */
+static uint8 g_keyCount = 0;
 /*
- * This flag is used to indicate if a certain amount of ticks has been reached
- * In this codes case, 15 and 60 seconds
+ * The command sent to the control, OPENDOOR or CHANGEPASS
  */
-static uint8 g_flag = 0;
+static uint8 g_command;
 /*
- * Ticks of timers
+ * Set when READY is received and the reply byte is expected next
  */
-static uint32 g_tick = 0;
+static boolean g_gotReady = FALSE;
 /*
- * if timer is configuration overflow, use this in the call back
+ * State of the screens, the system starts by presenting the project name
  */
-static uint32 timerMode_num;
+static UiStateType g_uiState = UI_SPLASH;
+static PassStageType g_passStage = PASS_NEW;
+
 /*
- * take number of prescalar to use in timer equation
+ * Task that runs the keypad scanner after every system tick
  */
-static uint32 timerClock_num;
+void keypadTask(void);
 /*
- * this variable calculates the amount of ticks needed to reach,
+ * Task that runs the screens, it reacts to the keys, the control replies and its timeouts
  */
-static uint32 calc;
-
+void uiTask(void);
+/*
+ * Task that sends the changes of the LCD framebuffer one write per run, so the keys
+ * and the control replies are handled in between the writes of a redraw
+ */
+void lcdTask(void);
+/*
+ * Show the prompt of the password stage and start collecting the digits
+ */
+void startPass(PassStageType stage);
 /*
- * This code communicates with the control in order to open the door
+ * Handle a key pressed while entering the password
  */
-void openDoor(void);
+void passKey(uint8 key);
 /*
  * This code sends password to the control using UART
  */
 void sendPass(void);
 /*
- * Function to lock system if the user enters password wrong 3 times
+ * Read the control reply (READY then the reply byte) without waiting,
+ * returns TRUE when the reply byte is received
  */
-void lockSystem(void);
+boolean receiveReply(uint8 *reply);
 /*
- * Function to recieve system password from the user for the first time, if returns 0 if both passworrds don't match, and 1 if they do
+ * Handle the control reply about the password
  */
-uint8 firstPass(void);
+void passResult(uint8 reply);
 /*
- * Same as the firstPass function but different name
+ * Show the main options, open door or change password
  */
-void changePass(void);
+void showMenu(void);
 /*
- * This is the call-back function for the timer driver
+ * Clear the LCD for a new screen, the keys typed for the old screen are dropped
+ * and the keys typed from now on are kept for the new one
  */
-void timer_callBack(void)
+void newScreen(void);
+/*
+ * Called by the scheduler when no task is ready, a_ms is the time to the next wake up
+ */
+void idleHook(uint32 a_ms);
+/*
+ * This is the call-back function for the UART driver, called for every received byte
+ */
+void uart_callBack(void)
 {
-	g_tick++;
-	if(g_tick == calc)
-	{
-		g_tick = 0;
-		g_flag = 1;
-	}
+	SCHED_setEvent(EVENT_UART_RX);
 }
 /*
- * This function is used to calculate the ticks needed for any prescalar, any mode and any timer
+ * This is the call-back function for the keypad scanner, called for every queued key
  */
-void timerCalculations();
+void keypad_callBack(void)
+{
+	SCHED_setEvent(EVENT_KEY);
+}
 
 /*------------------------------------------------------------------------------
  *  						Application Code
@@ -128,366 +192,382 @@ int main()
 	 */
 	UART_init(&UART_Configurations);
 	LCD_init();
+
+	/*
+	 * Start the millisecond time base used for timeouts and time stamps,
+	 * then the ISR and CPU load statistics that are measured with it
+	 */
+	Timer_startSystemClock();
+	PROFILER_init();
+
+	/*
+	 * Start the time of day, it keeps counting while the CPU sleeps
+	 */
+	RTC_init();
+
+	/*
+	 * The screens run as a task that waits on its events or wake up time instead of
+	 * spinning. The system tick only sets SCHED_EVENT_TICK, the keypad task is added
+	 * first so it scans before the other tasks run
+	 */
+	SCHED_init();
+	SCHED_addTask(keypadTask, SCHED_EVENT_TICK);
+	g_uiTask = SCHED_addTask(uiTask, EVENT_UART_RX | EVENT_KEY);
+	g_lcdTask = SCHED_addTask(lcdTask, 0);
+	SCHED_setIdleHook(idleHook);
+
+	UART_setReceiveCallBack(uart_callBack);
+	KEYPAD_setCallBack(keypad_callBack);
+	KEYPAD_init();
+
 	/*
 	 * Start by Presenting on the screen the Project name
 	 */
-	LCD_displayString("Door System Lock");
-	_delay_ms(2000);
+	LCD_displayString_P(PSTR("Door System Lock"));
+	SCHED_setReady(g_lcdTask);
+	SCHED_wakeAfter(g_uiTask, SPLASH_TIME);
+
+	SCHED_run();
+}
+
+
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+void keypadTask(void)
+{
+	/*
+	 * Not at the first run, the scanner counts system ticks
+	 */
+	if(SCHED_getEvents() & SCHED_EVENT_TICK)
+	{
+		KEYPAD_tick();
+	}
+}
+
+void uiTask(void)
+{
+	SCHED_EventType events = SCHED_getEvents();
+	KEYPAD_EventType keyEvent;
+	uint8 reply;
 
 	/*
-	 * This infinite loop exists to allow the user to enter first system password as much as needed with no errors
+	 * Take one event from the keypad queue per run, the task runs again for the
+	 * next one so every key is handled by the screen it was typed on.
+	 * The screens only use the presses, a held key is not typed again
 	 */
-	for(;;)
+	if(events & EVENT_KEY)
 	{
+		if(KEYPAD_getEvent(&keyEvent))
+		{
+			SCHED_setEvent(EVENT_KEY);
+		}
+		else
+		{
+			keyEvent.kind = KEYPAD_EVENT_RELEASE;
+		}
 
-		if(firstPass())
+		if(keyEvent.kind == KEYPAD_EVENT_PRESS)
 		{
-			/* Do nothing*/
+			g_key = keyEvent.key;
 		}
 		else
 		{
-			break;
+			events &= ~EVENT_KEY;
 		}
 	}
 
-	/*
-	 * This infinite loop is for the system.
-	 * has 2 options: Open door or Change Password
-	 */
-	for(;;)
+	switch(g_uiState)
 	{
-		/*
-		 * Always display these 2 options after every
-		 */
-		LCD_clearScreen();
-		LCD_moveCursor(0,0);
-		LCD_displayString("+ : OPEN DOOR");
-		LCD_moveCursor(1,0);
-		LCD_displayString("- : Change Pass");
-
-		g_key = 100;
-
-		/*
-		 * While the keys + and - are not pressed, stay here
-		 */
-		while(g_key != '+' && g_key != '-')
+	case UI_SPLASH:
+		if(events & SCHED_EVENT_TIMEOUT)
 		{
-			_delay_ms(350);
-			g_key = KEYPAD_getPressedKey();
+			/*
+			 * Ask for the first system password
+			 */
+			startPass(PASS_NEW);
 		}
-
-		/*
-		 * Code for opening door
-		 */
-		if(g_key == '+')
+		break;
+	case UI_MENU:
+		if((events & EVENT_KEY) && ((g_key == '+') || (g_key == '-')))
 		{
 			/*
-			 * Send to control that the open door function has been chosen
+			 * Send to control the chosen function, then enter the password
+			 * and send it over to make sure it is correct
 			 */
-			UART_sendByte(OPENDOOR);
+			g_command = (g_key == '+') ? OPENDOOR : CHANGEPASS;
+			UART_sendByte(g_command);
+			fail_counter = 0;
+			startPass(PASS_CHECK);
+		}
+		break;
+	case UI_ENTER_PASS:
+		if(events & EVENT_KEY)
+		{
+			passKey(g_key);
+		}
+		break;
+	case UI_WAIT_RESULT:
+		if(receiveReply(&reply))
+		{
+			passResult(reply);
+		}
+		break;
+	case UI_DOOR_OPENING:
+		if(events & SCHED_EVENT_TIMEOUT)
+		{
+			newScreen();
+			LCD_displayStringRowColumn_P(0,0,PSTR("Wait for people"));
+			LCD_displayStringRowColumn_P(1,3,PSTR("to enter"));
+
 			/*
-			 * Enter password and send it over to make sure it is correct
+			 * The control may have already sent that people passed
 			 */
-			for(fail_counter = 0; fail_counter < 3; fail_counter++)
-			{
-				LCD_clearScreen();
-				LCD_displayString("Enter Old Pass:");
-				LCD_moveCursor(1,0);
-				sendPass();
-
-				while(UART_recieveByte() != READY);
-
-				if(UART_recieveByte())
-				{
-					/* Do nothing*/
-				}
-				else
-				{
-					break;
-				}
-			}
-
-			if(fail_counter == 3)
-			{
-				/*
-				 * Function to lock system
-				 */
-				lockSystem();
-			}
-			else
-			{
-				/*
-				 * Function to open door
-				 */
-				openDoor();
-			}
+			g_uiState = UI_WAIT_PEOPLE;
+			SCHED_setReady(g_uiTask);
 		}
+		break;
+	case UI_WAIT_PEOPLE:
 		/*
-		 * Code for changing password
+		 * Wait till people pass
 		 */
-		else if(g_key == '-')
+		if(receiveReply(&reply) && (reply == NO_PEOPLE))
 		{
-			/*
-			 * Send to control that the change password function has been chosen
-			 */
-			UART_sendByte(CHANGEPASS);
-			/*
-			 * Enter password and send it over to make sure it is correct
-			 */
-			for(fail_counter = 0; fail_counter < 3; fail_counter++)
-			{
-				LCD_clearScreen();
-				LCD_displayString("Enter Old Pass:");
-				LCD_moveCursor(1,0);
-				sendPass();
-
-				while(UART_recieveByte() != READY);
-
-				if(UART_recieveByte())
-				{
-					/* Do nothing*/
-				}
-				else
-				{
-					break;
-				}
-			}
-
-			if(fail_counter == 3)
-			{
-				/*
-				 * Function to lock system
-				 */
-				lockSystem();
-			}
-			else
-			{
-				/*
-				 * Function to change password
-				 */
-				changePass();
-			}
+			newScreen();
+			LCD_displayStringRowColumn_P(0,2,PSTR("Door Closing"));
+			LCD_displayStringRowColumn_P(1,4,PSTR("Please Wait"));
+
+			g_uiState = UI_DOOR_CLOSING;
+			SCHED_wakeAfter(g_uiTask, DOORTIME * 1000UL);
 		}
+		break;
+	case UI_DOOR_CLOSING:
+	case UI_LOCKED:
+		if(events & SCHED_EVENT_TIMEOUT)
+		{
+			showMenu();
+		}
+		break;
 	}
+
+	/*
+	 * The screens write in the LCD framebuffer, the LCD task sends what changed
+	 */
+	SCHED_setReady(g_lcdTask);
 }
 
+void lcdTask(void)
+{
+	/*
+	 * Run again while the LCD is busy or changes are left, the scheduler runs the
+	 * screens first when a key or a byte comes in meanwhile
+	 */
+	if(LCD_refresh())
+	{
+		SCHED_setReady(g_lcdTask);
+	}
+}
 
+void startPass(PassStageType stage)
+{
+	newScreen();
+	switch(stage)
+	{
+	case PASS_NEW:
+		LCD_displayString_P(PSTR("Enter Pass:"));
+		break;
+	case PASS_CONFIRM:
+		LCD_displayStringRowColumn_P(0,0,PSTR("Re-Enter Pass:"));
+		break;
+	case PASS_CHECK:
+		LCD_displayString_P(PSTR("Enter Old Pass:"));
+		break;
+	}
+	LCD_moveCursor(1,0);
 
-/*------------------------------------------------------------------------------
- *  							Function Definitions
- *----------------------------------------------------------------------------*/
+	g_passStage = stage;
+	g_keyCount = 0;
+	g_uiState = UI_ENTER_PASS;
+}
 
-void sendPass()
+void passKey(uint8 key)
 {
 	/*
-	 * This for loop is for entering a Password of 5 integers and storing them in an array
+	 * Entering a Password of 5 integers and storing them in an array
 	 */
-	for(uint8 count = 0; count < 5; count++)
+	if(g_keyCount < PASS_LENGTH)
 	{
-		g_key = 100;
-		while((g_key > 9) || (g_key < 0))
+		if(key <= 9)
 		{
-			_delay_ms(350);
-			g_key = KEYPAD_getPressedKey();
+			LCD_displayCharacter('*');   /* display the pressed keypad switch */
+			g_arrKey[g_keyCount] = key;
+			g_keyCount++;
 		}
-
-		LCD_displayCharacter('*');   /* display the pressed keypad switch */
-
-		g_arrKey[count] = g_key;
+		return;
 	}
 
 	/*
 	 * Wait for the user to press the enter key then start the transmission using UART
 	 */
-	while(g_key != KEYPAD_ENTER_KEY)
+	if(key != KEYPAD_ENTER_KEY)
 	{
-		_delay_ms(350);
-		g_key = KEYPAD_getPressedKey();
+		return;
 	}
 
-	UART_sendByte(READY);
+	sendPass();
 
-	for(uint8 i = 0; i < 5; i++)
+	if(g_passStage == PASS_NEW)
 	{
-		_delay_ms(50);
-		UART_sendByte(g_arrKey[i]);
+		startPass(PASS_CONFIRM);
 	}
-}
-
-void openDoor()
-{
-	timerCalculations();
-
-	_delay_ms(100);
-	calc = (DOORTIME*CPU_FREQ)/(timerMode_num * timerClock_num);
-
-	/*
-	 * Start the timer and set callback function
-	 */
-
-	g_tick = 0;
-	g_flag = 0;
-	Timer_setCallBack(timer_callBack, Timer_Configurations.timer_ID);
-	Timer_init(&Timer_Configurations);
-
-
-
-	LCD_clearScreen();
-	LCD_moveCursor(0,3);
-	LCD_displayString("Door Opening");
-	LCD_moveCursor(1,4);
-	LCD_displayString("Please Wait");
-
-	/*
-	 * Display until the timer activates flag, which is in 15 seconds
-	 */
-	while(!g_flag);
-
-	LCD_clearScreen();
-	LCD_moveCursor(0,0);
-	LCD_displayString("Wait for people");
-	LCD_moveCursor(1,3);
-	LCD_displayString("to enter");
-
-	while(UART_recieveByte() != READY);
-
-	/*
-	 * Wait till people pass
-	 */
-	while(UART_recieveByte() != NO_PEOPLE);
-
-	g_flag = 0;
-	g_tick = 0;
-
-	LCD_clearScreen();
-	LCD_moveCursor(0,2);
-	LCD_displayString("Door Closing");
-	LCD_moveCursor(1,4);
-	LCD_displayString("Please Wait");
-
-	/*
-	 * Display until the timer activates flag, which is in 15 seconds
-	 */
-	while(!g_flag);
+	else
+	{
+		if(g_passStage == PASS_CONFIRM)
+		{
+			newScreen();
+		}
 
-	Timer_deinit(Timer_Configurations.timer_ID);
+		/*
+		 * Wait for signal which indicates whether the password is accepted
+		 */
+		g_gotReady = FALSE;
+		g_uiState = UI_WAIT_RESULT;
+		SCHED_setReady(g_uiTask);
+	}
 }
 
-void lockSystem()
+void sendPass(void)
 {
-	timerCalculations();
-
-	_delay_ms(100);
-	calc = (LOCKTIME*CPU_FREQ)/(timerMode_num * timerClock_num);
-	/*
-	 * Start the timer and set callback function
-	 */
-
-	Timer_setCallBack(timer_callBack, Timer_Configurations.timer_ID);
-	Timer_init(&Timer_Configurations);
-	g_tick = 0;
-	g_flag = 0;
-
-	LCD_clearScreen();
-	LCD_moveCursor(0,2);
-	LCD_displayString("SYSTEM LOCKED");
-	LCD_moveCursor(1,0);
-	LCD_displayString("Wait 1 minute");
-
-	/*
-	 * Wait for timer to raise flag, 60 seconds
-	 */
-	while(!g_flag);
+	UART_sendByte(READY);
 
-	Timer_deinit(Timer_Configurations.timer_ID);
+	for(uint8 i = 0; i < PASS_LENGTH; i++)
+	{
+		UART_sendByte(g_arrKey[i]);
+	}
 }
 
-uint8 firstPass(void)
+boolean receiveReply(uint8 *reply)
 {
-	LCD_clearScreen();
-	LCD_displayString("Enter Pass:");
-	LCD_moveCursor(1,0);
-
-	sendPass();
-
-	LCD_clearScreen();
-	LCD_moveCursor(0,0);
-	LCD_displayString("Re-Enter Pass:");
-	LCD_moveCursor(1,0);
+	uint8 data;
 
-	sendPass();
-
-	LCD_clearScreen();
-
-	/*
-	 * Wait for signal which indicates whether the passwords match or don't
-	 * if yes, exit the for loop, which in this case is the function of else
-	 */
-	while(UART_recieveByte() != READY);
+	while(UART_tryReceiveByte(&data))
+	{
+		if(g_gotReady)
+		{
+			g_gotReady = FALSE;
+			*reply = data;
+			return TRUE;
+		}
+		else if(data == READY)
+		{
+			g_gotReady = TRUE;
+		}
+	}
 
-	return UART_recieveByte();
+	return FALSE;
 }
 
-
-void changePass()
+void passResult(uint8 reply)
 {
-	for(;;)
+	if(g_passStage == PASS_CONFIRM)
 	{
-		if(firstPass())
+		/*
+		 * The new password is stored if both entries match, otherwise enter it again
+		 */
+		if(reply == NO_REPEAT)
 		{
-			/* Do nothing*/
+			showMenu();
 		}
 		else
 		{
-			break;
+			startPass(PASS_NEW);
 		}
 	}
-}
-
-
-void timerCalculations()
-{
-	timerMode_num = Timer_Configurations.timer_compare_MatchValue - Timer_Configurations.timer_InitialValue;
+	else if(reply == NO_REPEAT)
+	{
+		if(g_command == OPENDOOR)
+		{
+			newScreen();
+			LCD_displayStringRowColumn_P(0,3,PSTR("Door Opening"));
+			LCD_displayStringRowColumn_P(1,4,PSTR("Please Wait"));
 
-	if(Timer_Configurations.timer_mode == MODE_normal)
+			/*
+			 * Display until the door is open, which is in 15 seconds
+			 */
+			g_uiState = UI_DOOR_OPENING;
+			SCHED_wakeAfter(g_uiTask, DOORTIME * 1000UL);
+		}
+		else
+		{
+			startPass(PASS_NEW);
+		}
+	}
+	else
 	{
-		if(Timer_Configurations.timer_ID == TIMER_timer1)
+		fail_counter++;
+		if(fail_counter == MAX_FAILS)
 		{
-			timerMode_num = 65535 - Timer_Configurations.timer_InitialValue;
+			/*
+			 * Lock system for 60 seconds
+			 */
+			newScreen();
+			LCD_displayStringRowColumn_P(0,2,PSTR("SYSTEM LOCKED"));
+			LCD_displayStringRowColumn_P(1,0,PSTR("Wait 1 minute"));
+
+			g_uiState = UI_LOCKED;
+			SCHED_wakeAfter(g_uiTask, LOCKTIME * 1000UL);
 		}
 		else
 		{
-			timerMode_num = 255 - Timer_Configurations.timer_InitialValue;
+			startPass(PASS_CHECK);
 		}
 	}
+}
 
-	_delay_ms(100);
+void showMenu(void)
+{
+	/*
+	 * Always display these 2 options after every operation
+	 */
+	newScreen();
+	LCD_displayStringRowColumn_P(0,0,PSTR("+ : OPEN DOOR"));
+	LCD_displayStringRowColumn_P(1,0,PSTR("- : Change Pass"));
 
-	switch(Timer_Configurations.timer_clock)
+	g_uiState = UI_MENU;
+}
+
+void newScreen(void)
+{
+	KEYPAD_flush();
+	LCD_clearScreen();
+}
+
+void idleHook(uint32 a_ms)
+{
+	/*
+	 * The menu and the password screens wait only for keys, nothing is timed and the
+	 * control sends nothing, so power down until a key is pressed. Only the RTC runs,
+	 * it wakes the CPU every second to keep the time.
+	 * The UART stops in power-save: a byte still being sent would be cut, and a reply
+	 * of the control can not wake the CPU, so the screens that wait for one use idle
+	 */
+	if((a_ms == SCHED_NO_WAKE) && ((g_uiState == UI_MENU) || (g_uiState == UI_ENTER_PASS)) &&
+	   UART_isSendComplete() && KEYPAD_armWake())
+	{
+		RTC_sleep();
+		KEYPAD_disarmWake();
+	}
+	else
 	{
-		case NO_CLOCK:
-			timerClock_num = 0;
-			break;
-		case F_CPU_CLOCK:
-			timerClock_num = 1;
-			break;
-		case F_CPU_8:
-			timerClock_num = 8;
-			break;
-		case F_CPU_32_T2:
-			timerClock_num = 32;
-			break;
-		case F_CPU_64:
-			timerClock_num = 64;
-			break;
-		case F_CPU_128_T2:
-			timerClock_num = 128;
-			break;
-		case F_CPU_256:
-			timerClock_num = 256;
-			break;
-		case F_CPU_1024:
-			timerClock_num = 1024;
-			break;
+		/*
+		 * Stop the CPU only, the timers and the UART keep running and wake it
+		 */
+		set_sleep_mode(SLEEP_MODE_IDLE);
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
 	}
 }
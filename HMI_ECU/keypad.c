@@ -6,161 +6,591 @@
  *----------------------------------------------------------------------------*/
 #include "keypad.h"
 #include "gpio.h"
-#include <util/delay.h>
+#include <avr/io.h> /* To use the SREG Register */
+#include <avr/interrupt.h> /* For cli */
+#include <avr/cpufunc.h> /* For _NOP */
+#include <avr/pgmspace.h> /* To keep the keymap in flash */
+
+#if ((KEYPAD_QUEUE_SIZE & (KEYPAD_QUEUE_SIZE - 1)) != 0)
+#error "KEYPAD_QUEUE_SIZE must be a power of two"
+#endif
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Debounce states of the scanned key
+ */
+typedef enum
+{
+	KEYPAD_IDLE, KEYPAD_PRESSING, KEYPAD_HELD, KEYPAD_RELEASING
+}KEYPAD_StateType;
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Queue of the key events, the scanner writes at the head and the
+ * application reads from the tail
+ */
+static volatile KEYPAD_EventType g_eventQueue[KEYPAD_QUEUE_SIZE];
+static volatile uint8 g_eventHead = 0;
+static volatile uint8 g_eventTail = 0;
+
+/*
+ * Pointer to the function called after every queued event
+ */
+static void (*volatile g_keyCallBackPtr)(void) = NULL_PTR;
+
+/*
+ * Set by the any key interrupt, the keypad is scanned while it is set.
+ * g_scanTicks counts the system ticks to the next scan
+ */
+static volatile boolean g_scanning = FALSE;
+static volatile uint8 g_scanTicks = 0;
+
+/*
+ * Debounce state and the key it follows. g_stateScans counts the scans that
+ * agree while pressing or releasing, g_heldScans and g_repeatScans count the
+ * scans to the long press and to the next repeat while the key is held
+ */
+static KEYPAD_StateType g_state = KEYPAD_IDLE;
+static uint8 g_stateKey = KEYPAD_NO_KEY;
+static uint8 g_stateScans = 0;
+static uint8 g_heldScans = 0;
+static uint8 g_repeatScans = 0;
+
+/*
+ * Buttons pressed in the last scan
+ */
+static volatile uint16 g_matrix = 0;
+
+/*
+ * g_wakeArmed is set while the any key interrupt senses the low level to wake the
+ * CPU, g_wokenByKey when it did. g_wakeMeasuring is set from waking up until the
+ * press event, which takes g_wakeLatency microseconds
+ */
+static volatile boolean g_wakeArmed = FALSE;
+static volatile boolean g_wokenByKey = FALSE;
+static volatile boolean g_wakeMeasuring = FALSE;
+static uint32 g_wakeMicros = 0;
+static volatile uint32 g_wakeLatency = 0;
+
+/*
+ * Key of every button selected by KEYPAD_KEYMAP, kept in flash
+ */
+static const uint8 g_keymap[KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS] PROGMEM = KEYPAD_KEYMAP;
 
 /*------------------------------------------------------------------------------
  *  							Function Prototypes
  *----------------------------------------------------------------------------*/
 
-#ifndef STANDARD_KEYPAD
+/*
+ * Call back of the any key interrupt, starts scanning at the next system tick
+ */
+static void KEYPAD_anyKey(void);
 
-#if (KEYPAD_NUM_COLS == 3)
 /*
- * Function responsible for mapping the switch number in the keypad to
- * its corresponding functional number in the proteus for 4x3 keypad
+ * Put an event of the debounced key in the queue and call the call back
  */
-static uint8 KEYPAD_4x3_adjustKeyNumber(uint8 button_number);
-#elif (KEYPAD_NUM_COLS == 4)
+static void KEYPAD_queueEvent(KEYPAD_EventKindType a_kind);
+
 /*
- * Function responsible for mapping the switch number in the keypad to
- * its corresponding functional number in the proteus for 4x4 keypad
+ * Return the key of the pressed buttons of a matrix
  */
-static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
-#endif
+static uint8 KEYPAD_matrixToKey(uint16 a_matrix);
 
-#endif /* STANDARD_KEYPAD */
+/*
+ * Change the sense of the any key interrupt
+ */
+static void KEYPAD_setAnyKeySense(EXTI_SenseType a_sense);
 
 /*------------------------------------------------------------------------------
  *  							Function Definitions
  *----------------------------------------------------------------------------*/
 
+/*
+ * Description :
+ * Start the background scanner with an empty event queue
+ */
+void KEYPAD_init(void)
+{
+	g_eventHead = 0;
+	g_eventTail = 0;
+	g_state = KEYPAD_IDLE;
+	g_scanning = FALSE;
+
+	KEYPAD_enableAnyKey(KEYPAD_anyKey);
+
+	/*
+	 * Scan once at the next tick, it arms the any key interrupt if no key is held
+	 */
+	KEYPAD_anyKey();
+}
+
+/*
+ * Description :
+ * Get the Keypad pressed button, waits until the scanner queues a press
+ */
 uint8 KEYPAD_getPressedKey(void)
 {
-	uint8 col,row;
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+1, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+2, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+3, PIN_INPUT);
-
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+1, PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+2, PIN_INPUT);
-#if(KEYPAD_NUM_COLS == 4)
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID+3, PIN_INPUT);
-#endif
-	while(1)
+	KEYPAD_EventType event;
+
+	do
 	{
-		for(row=0 ; row<KEYPAD_NUM_ROWS ; row++) /* loop for rows */
+		while(!KEYPAD_getEvent(&event)){}
+	}while(event.kind != KEYPAD_EVENT_PRESS);
+
+	return event.key;
+}
+
+/*
+ * Description :
+ * Take the oldest key event from the queue without waiting.
+ * Returns FALSE if the queue is empty
+ */
+boolean KEYPAD_getEvent(KEYPAD_EventType *a_event)
+{
+	if(g_eventTail == g_eventHead)
+	{
+		return FALSE;
+	}
+
+	/*
+	 * Only the application moves the tail, the tick only reads it
+	 */
+	a_event->key = g_eventQueue[g_eventTail].key;
+	a_event->kind = g_eventQueue[g_eventTail].kind;
+	g_eventTail = (g_eventTail + 1) & (KEYPAD_QUEUE_SIZE - 1);
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Drop all the queued events, call it when the screen changes so the keys typed
+ * for the old screen are not used by the new one
+ */
+void KEYPAD_flush(void)
+{
+	/*
+	 * Only the application moves the tail, the head is one byte so it is read at once
+	 */
+	g_eventTail = g_eventHead;
+}
+
+/*
+ * Description :
+ * Set the function called from KEYPAD_tick every time an event is queued
+ */
+void KEYPAD_setCallBack(void(*a_ptr)(void))
+{
+	uint8 sreg = SREG;
+
+	/* The pointer is two bytes, do not let the ISR see half of it */
+	cli();
+	g_keyCallBackPtr = a_ptr;
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Scan the keypad if a key is held, call it from a task after every system tick
+ * (a task waiting on SCHED_EVENT_TICK)
+ */
+void KEYPAD_tick(void)
+{
+	uint8 key;
+	uint8 sreg;
+
+	if(!g_scanning)
+	{
+		return;
+	}
+	if(++g_scanTicks < KEYPAD_SCAN_TICKS)
+	{
+		return;
+	}
+	g_scanTicks = 0;
+
+	g_matrix = KEYPAD_readMatrix();
+	key = KEYPAD_matrixToKey(g_matrix);
+
+	switch(g_state)
+	{
+	case KEYPAD_IDLE:
+		if(key == KEYPAD_NO_KEY)
 		{
-			/* 
-			 * Each time setup the direction for all keypad port as input pins,
-			 * except this row will be output pin
+			/*
+			 * All the keys are released, wait for the any key interrupt. It must not
+			 * start scanning again before the rows are driven
 			 */
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_OUTPUT);
+			sreg = SREG;
+			cli();
+			g_scanning = FALSE;
+			g_wakeMeasuring = FALSE;
+			KEYPAD_armAnyKey();
+			SREG = sreg;
+		}
+		else
+		{
+			g_stateKey = key;
+			g_stateScans = 0;
+			g_state = KEYPAD_PRESSING;
+		}
+		break;
+	case KEYPAD_PRESSING:
+		if(key != g_stateKey)
+		{
+			/* A bounce or another key, start again from the next scan */
+			g_state = KEYPAD_IDLE;
+		}
+		else if(++g_stateScans >= KEYPAD_DEBOUNCE_SCANS)
+		{
+			g_heldScans = 0;
+			g_repeatScans = KEYPAD_REPEAT_DELAY_SCANS;
+			g_state = KEYPAD_HELD;
+			KEYPAD_queueEvent(KEYPAD_EVENT_PRESS);
 
-			/* Set/Clear the row output pin */
-			GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_FIRST_ROW_PIN_ID+row, KEYPAD_BUTTON_PRESSED);
+			if(g_wakeMeasuring)
+			{
+				g_wakeMeasuring = FALSE;
+				g_wakeLatency = Timer_getMicros() - g_wakeMicros;
+			}
+		}
+		break;
+	case KEYPAD_HELD:
+	case KEYPAD_RELEASING:
+		if(key != g_stateKey)
+		{
+			if(g_state == KEYPAD_HELD)
+			{
+				g_stateScans = 0;
+				g_state = KEYPAD_RELEASING;
+			}
+			if(++g_stateScans >= KEYPAD_DEBOUNCE_SCANS)
+			{
+				g_state = KEYPAD_IDLE;
+				KEYPAD_queueEvent(KEYPAD_EVENT_RELEASE);
+			}
+			break;
+		}
 
-			for(col=0 ; col<KEYPAD_NUM_COLS ; col++) /* loop for columns */
+		/*
+		 * Still held, a bounce while releasing does not restart the hold times
+		 */
+		g_state = KEYPAD_HELD;
+		if(g_heldScans < KEYPAD_LONG_PRESS_SCANS)
+		{
+			if(++g_heldScans == KEYPAD_LONG_PRESS_SCANS)
 			{
-				/* Check if the switch is pressed in this column */
-				if(GPIO_readPin(KEYPAD_COL_PORT_ID,KEYPAD_FIRST_COL_PIN_ID+col) == KEYPAD_BUTTON_PRESSED)
-				{
-					#if (KEYPAD_NUM_COLS == 3)
-						#ifdef STANDARD_KEYPAD
-							return ((row*KEYPAD_NUM_COLS)+col+1);
-						#else
-							return KEYPAD_4x3_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-						#endif
-					#elif (KEYPAD_NUM_COLS == 4)
-						#ifdef STANDARD_KEYPAD
-							return ((row*KEYPAD_NUM_COLS)+col+1);
-						#else
-							return KEYPAD_4x4_adjustKeyNumber((row*KEYPAD_NUM_COLS)+col+1);
-						#endif
-					#endif
-				}
+				KEYPAD_queueEvent(KEYPAD_EVENT_LONG_PRESS);
 			}
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,KEYPAD_FIRST_ROW_PIN_ID+row,PIN_INPUT);
-			_delay_ms(5); /* Add small delay to fix CPU load issue in proteus */
 		}
-	}	
-}
-
-#ifndef STANDARD_KEYPAD
-
-#if (KEYPAD_NUM_COLS == 3)
-/*
- * Description :
- * Update the keypad pressed button value with the correct one in keypad 4x3 shape
- */
-static uint8 KEYPAD_4x3_adjustKeyNumber(uint8 button_number)
-{
-	uint8 keypad_button = 0;
-	switch(button_number)
-	{
-		case 10: keypad_button = '*'; // ASCII Code of *
-				 break;
-		case 11: keypad_button = 0;
-				 break;		
-		case 12: keypad_button = '#'; // ASCII Code of #
-				 break;
-		default: keypad_button = button_number;
-				break;
-	}
-	return keypad_button;
-} 
-
-#elif (KEYPAD_NUM_COLS == 4)
-
-/*
- * Description :
- * Update the keypad pressed button value with the correct one in keypad 4x4 shape
- */
-static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number)
-{
-	uint8 keypad_button = -1;
-	switch(button_number)
-	{
-		case 1: keypad_button = 7;
-				break;
-		case 2: keypad_button = 8;
-				break;
-		case 3: keypad_button = 9;
-				break;
-		case 4:
-				break;
-		case 5: keypad_button = 4;
-				break;
-		case 6: keypad_button = 5;
-				break;
-		case 7: keypad_button = 6;
-				break;
-		case 8:
-				break;		
-		case 9: keypad_button = 1;
-				break;
-		case 10: keypad_button = 2;
-				break;
-		case 11: keypad_button = 3;
-				break;
-		case 12: keypad_button = '-'; /* ASCII Code of '-' */
-				break;
-		case 13:
-				break;			
-		case 14: keypad_button = 0;
-				break;
-		case 15:
-		         keypad_button = KEYPAD_ENTER_KEY;
-				break;
-		case 16: keypad_button = '+'; /* ASCII Code of '+' */
-				break;
-		default:
-				break;
-	}
-	return keypad_button;
-} 
+		if(--g_repeatScans == 0)
+		{
+			g_repeatScans = KEYPAD_REPEAT_PERIOD_SCANS;
+			KEYPAD_queueEvent(KEYPAD_EVENT_REPEAT);
+		}
+		break;
+	}
+}
+
+/*
+ * Description :
+ * Scan all the keypad rows once and return the pressed button without waiting,
+ * KEYPAD_NO_KEY if no button is pressed, KEYPAD_MULTI_KEY or KEYPAD_GHOST_KEY.
+ * The background scanner uses it, do not call it while the scanner is started
+ */
+uint8 KEYPAD_readKey(void)
+{
+	return KEYPAD_matrixToKey(KEYPAD_readMatrix());
+}
 
+/*
+ * Description :
+ * Scan all the keypad rows once, reading all the columns of a row at once, and
+ * return the pressed buttons as KEYPAD_MATRIX_BIT bits
+ */
+uint16 KEYPAD_readMatrix(void)
+{
+	uint16 matrix = 0;
+	uint8 row,rowBit,cols;
+	uint8 sreg = SREG;
+
+	/*
+	 * The registers are written directly instead of through the GPIO functions, that
+	 * costs a few cycles per row. The other pins of the ports belong to other drivers,
+	 * so no interrupt may change them between reading and writing the registers
+	 */
+	cli();
+
+	/*
+	 * All the rows and the columns are inputs until a row is scanned, a row drives
+	 * the pressed level only while it is an output
+	 */
+	GPIO_DDR(KEYPAD_COL_PORT) &= (uint8)~KEYPAD_COL_MASK;
+	GPIO_DDR(KEYPAD_ROW_PORT) &= (uint8)~KEYPAD_ROW_MASK;
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_HIGH)
+	GPIO_PORT(KEYPAD_ROW_PORT) |= KEYPAD_ROW_MASK;
+#else
+	GPIO_PORT(KEYPAD_ROW_PORT) &= (uint8)~KEYPAD_ROW_MASK;
 #endif
 
-#endif /* STANDARD_KEYPAD */
+	rowBit = 1 << KEYPAD_FIRST_ROW_PIN;
+	for(row=0 ; row<KEYPAD_NUM_ROWS ; row++, rowBit <<= 1) /* loop for rows */
+	{
+		GPIO_DDR(KEYPAD_ROW_PORT) |= rowBit;
+
+		/* The pin inputs are synchronized, give the new level one cycle to reach PINx */
+		_NOP();
+
+		/* Read all the columns of this row at once, a pressed column reads 1 */
+		cols = GPIO_PIN(KEYPAD_COL_PORT) & KEYPAD_COL_MASK;
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+		cols ^= KEYPAD_COL_MASK;
+#endif
+
+		/* Release the row again before scanning the next one */
+		GPIO_DDR(KEYPAD_ROW_PORT) &= (uint8)~rowBit;
+
+		matrix |= (uint16)(cols >> KEYPAD_FIRST_COL_PIN) << (row * KEYPAD_NUM_COLS);
+	}
+
+	SREG = sreg;
+
+	return matrix;
+}
+
+/*
+ * Description :
+ * Return TRUE if the pressed buttons of a_matrix may be ghosts: two rows that share
+ * two columns close a loop, so any corner of it reads pressed if the other three are
+ */
+boolean KEYPAD_isGhosted(uint16 a_matrix)
+{
+	uint8 row,other,common;
+	uint8 cols[KEYPAD_NUM_ROWS];
+
+	for(row=0 ; row<KEYPAD_NUM_ROWS ; row++)
+	{
+		cols[row] = (a_matrix >> (row * KEYPAD_NUM_COLS)) & ((1 << KEYPAD_NUM_COLS) - 1);
+	}
+
+	for(row=0 ; row<KEYPAD_NUM_ROWS ; row++)
+	{
+		for(other=row+1 ; other<KEYPAD_NUM_ROWS ; other++)
+		{
+			common = cols[row] & cols[other];
+
+			/* More than one bit in common */
+			if(common & (common - 1))
+			{
+				return TRUE;
+			}
+		}
+	}
+
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Return the buttons pressed in the last scan of the background scanner
+ */
+uint16 KEYPAD_getMatrix(void)
+{
+	uint16 matrix;
+	uint8 sreg = SREG;
+
+	/* The matrix is two bytes, do not let the tick change half of it */
+	cli();
+	matrix = g_matrix;
+	SREG = sreg;
+
+	return matrix;
+}
+
+/*
+ * Description :
+ * Set up the any key interrupt, a_ptr is called from it when a key is pressed
+ * after KEYPAD_armAnyKey
+ */
+void KEYPAD_enableAnyKey(void(*a_ptr)(void))
+{
+	EXTI_setCallBack(a_ptr, KEYPAD_ANY_KEY_EXTI);
+	KEYPAD_setAnyKeySense(EXTI_FALLING_EDGE);
+}
+
+/*
+ * Description :
+ * Drive all the rows so the next pressed key makes the any key interrupt,
+ * call it when KEYPAD_readKey returns KEYPAD_NO_KEY since scanning releases the rows
+ */
+void KEYPAD_armAnyKey(void)
+{
+	/*
+	 * Scanning a held key toggles the line, forget those edges first so a key
+	 * pressed from now on is not lost
+	 */
+	EXTI_clearEvent(KEYPAD_ANY_KEY_EXTI);
+
+	GPIO_writePortMasked(GPIO_PORT_ID(KEYPAD_ROW_PORT), KEYPAD_ROW_MASK, (KEYPAD_BUTTON_PRESSED == LOGIC_HIGH) ? KEYPAD_ROW_MASK : 0);
+	GPIO_setupPortDirectionMasked(GPIO_PORT_ID(KEYPAD_ROW_PORT), KEYPAD_ROW_MASK, PORT_OUTPUT);
+}
+
+/*
+ * Description :
+ * Get ready for a sleep mode that stops the I/O clock, INT0 does not see edges
+ * without it so the any key interrupt senses the low level instead.
+ * Returns FALSE without changing anything while a key is being scanned
+ */
+boolean KEYPAD_armWake(void)
+{
+	if(g_scanning)
+	{
+		return FALSE;
+	}
+
+	/*
+	 * A held key interrupts as soon as the sense changes, the flag must be set first
+	 */
+	g_wakeArmed = TRUE;
+	KEYPAD_setAnyKeySense(EXTI_LOW_LEVEL);
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Call after waking up, the any key interrupt senses the edges again. If a key
+ * woke the CPU, the time from now to its press event is measured
+ */
+void KEYPAD_disarmWake(void)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	if(g_wakeArmed)
+	{
+		/* Something else woke the CPU */
+		g_wakeArmed = FALSE;
+		KEYPAD_setAnyKeySense(EXTI_FALLING_EDGE);
+	}
+	else if(g_wokenByKey)
+	{
+		g_wokenByKey = FALSE;
+		g_wakeMicros = Timer_getMicros();
+		g_wakeMeasuring = TRUE;
+	}
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Return the time in microseconds from the last wake up by a key to its press
+ * event, the oscillator start up time before the CPU runs is not included
+ */
+uint32 KEYPAD_getWakeLatency(void)
+{
+	uint32 latency;
+	uint8 sreg = SREG;
+
+	/* The latency is four bytes, do not let the tick change part of it */
+	cli();
+	latency = g_wakeLatency;
+	SREG = sreg;
+
+	return latency;
+}
+
+/*
+ * Description :
+ * Return the key of the pressed buttons of a matrix
+ */
+static uint8 KEYPAD_matrixToKey(uint16 a_matrix)
+{
+	uint8 button = 0;
+
+	if(a_matrix == 0)
+	{
+		return KEYPAD_NO_KEY;
+	}
+	if(a_matrix & (a_matrix - 1))
+	{
+		return KEYPAD_isGhosted(a_matrix) ? KEYPAD_GHOST_KEY : KEYPAD_MULTI_KEY;
+	}
+
+	/* One bit is set, its place is the button in the keymap */
+	while(!(a_matrix & 1))
+	{
+		a_matrix >>= 1;
+		button++;
+	}
+
+	return pgm_read_byte(&g_keymap[button]);
+}
+
+/*
+ * Description :
+ * Call back of the any key interrupt, starts scanning at the next system tick
+ */
+static void KEYPAD_anyKey(void)
+{
+	/*
+	 * The low level keeps interrupting while the key is held, go back to the edges
+	 */
+	if(g_wakeArmed)
+	{
+		g_wakeArmed = FALSE;
+		g_wokenByKey = TRUE;
+		KEYPAD_setAnyKeySense(EXTI_FALLING_EDGE);
+	}
+
+	/*
+	 * Scanning a held key toggles the any key line too, those edges must not
+	 * move the next scan
+	 */
+	if(!g_scanning)
+	{
+		g_scanTicks = KEYPAD_SCAN_TICKS - 1;
+		g_scanning = TRUE;
+	}
+}
+
+/*
+ * Description :
+ * Change the sense of the any key interrupt
+ */
+static void KEYPAD_setAnyKeySense(EXTI_SenseType a_sense)
+{
+	EXTI_ConfigType KEYPAD_AnyKeyConfigurations = {KEYPAD_ANY_KEY_EXTI, a_sense, TRUE};
+
+	EXTI_init(&KEYPAD_AnyKeyConfigurations);
+}
+
+/*
+ * Description :
+ * Put an event of the debounced key in the queue and call the call back
+ */
+static void KEYPAD_queueEvent(KEYPAD_EventKindType a_kind)
+{
+	uint8 next = (g_eventHead + 1) & (KEYPAD_QUEUE_SIZE - 1);
+
+	/*
+	 * The event is dropped if the queue is full
+	 */
+	if(next != g_eventTail)
+	{
+		g_eventQueue[g_eventHead].key = g_stateKey;
+		g_eventQueue[g_eventHead].kind = a_kind;
+		g_eventHead = next;
+	}
+
+	if(g_keyCallBackPtr != NULL_PTR)
+	{
+		(*g_keyCallBackPtr)();
+	}
+}
@@ -9,6 +9,8 @@
 #define KEYPAD_H_
 
 #include "std_types.h"
+#include "exti.h"
+#include "timer.h"
 
 /*------------------------------------------------------------------------------
  * 					 Pre-Processor Constants and Configurations
@@ -19,11 +21,21 @@
 #define KEYPAD_NUM_ROWS                   4
 
 /* Keypad Port Configurations */
-#define KEYPAD_ROW_PORT_ID                PORTB_ID
-#define KEYPAD_FIRST_ROW_PIN_ID           PIN0_ID
+#define KEYPAD_ROW_PORT                   B
+#define KEYPAD_FIRST_ROW_PIN              0
 
-#define KEYPAD_COL_PORT_ID                PORTB_ID
-#define KEYPAD_FIRST_COL_PIN_ID           PIN4_ID
+#define KEYPAD_COL_PORT                   B
+#define KEYPAD_FIRST_COL_PIN              4
+
+/* Bits of the rows and the columns in their ports */
+#define KEYPAD_ROW_MASK                   (((1 << KEYPAD_NUM_ROWS) - 1) << KEYPAD_FIRST_ROW_PIN)
+#define KEYPAD_COL_MASK                   (((1 << KEYPAD_NUM_COLS) - 1) << KEYPAD_FIRST_COL_PIN)
+
+/*
+ * Any key line: the columns are wired to INT0 (PD2) through diodes, so while all the
+ * rows are driven a pressed key pulls the line low and the keypad does not need polling
+ */
+#define KEYPAD_ANY_KEY_EXTI               EXTI_INT0
 
 /* Keypad button logic configurations */
 #define KEYPAD_BUTTON_PRESSED            LOGIC_LOW
@@ -31,14 +43,212 @@
 
 #define KEYPAD_ENTER_KEY				 13
 
+/*
+ * Returned by KEYPAD_readKey when no button is pressed, when more than one button
+ * is pressed and when the pressed buttons may show keys that are not pressed
+ * (ghosting). The scanner reports the last two as keys, KEYPAD_getMatrix tells
+ * which buttons they are. KEYPAD_INVALID_KEY is the key of a button the keymap
+ * does not use
+ */
+#define KEYPAD_NO_KEY                    100
+#define KEYPAD_MULTI_KEY                 101
+#define KEYPAD_GHOST_KEY                 102
+#define KEYPAD_INVALID_KEY               103
+
+/*
+ * Keymaps: the key of every button, row by row from the first row and column.
+ * KEYPAD_KEYMAP selects the one kept in flash, a new layout is a new list here.
+ * The BUTTONS keymaps return the button numbers 1 - 12 or 1 - 16
+ */
+#define KEYPAD_KEYMAP_PROTEUS_4x3        { 1,   2, 3,   \
+                                           4,   5, 6,   \
+                                           7,   8, 9,   \
+                                           '*', 0, '#' }
+
+#define KEYPAD_KEYMAP_PROTEUS_4x4        { 7,                  8, 9,                KEYPAD_INVALID_KEY, \
+                                           4,                  5, 6,                KEYPAD_INVALID_KEY, \
+                                           1,                  2, 3,                '-',                \
+                                           KEYPAD_INVALID_KEY, 0, KEYPAD_ENTER_KEY, '+' }
+
+#define KEYPAD_KEYMAP_BUTTONS_4x3        { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 }
+#define KEYPAD_KEYMAP_BUTTONS_4x4        { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 }
+
+#ifdef STANDARD_KEYPAD
+#if (KEYPAD_NUM_COLS == 3)
+#define KEYPAD_KEYMAP                    KEYPAD_KEYMAP_BUTTONS_4x3
+#else
+#define KEYPAD_KEYMAP                    KEYPAD_KEYMAP_BUTTONS_4x4
+#endif
+#else
+#if (KEYPAD_NUM_COLS == 3)
+#define KEYPAD_KEYMAP                    KEYPAD_KEYMAP_PROTEUS_4x3
+#else
+#define KEYPAD_KEYMAP                    KEYPAD_KEYMAP_PROTEUS_4x4
+#endif
+#endif
+
+/* Bit of a button in the matrix read by KEYPAD_readMatrix */
+#define KEYPAD_MATRIX_BIT(ROW, COL)      ((uint16)1 << (((ROW) * KEYPAD_NUM_COLS) + (COL)))
+
+#if ((KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS) > 16)
+#error "The keypad matrix must fit 16 bits"
+#endif
+
+/*
+ * Background scanner: after the any key interrupt the keypad is scanned every
+ * KEYPAD_SCAN_TICKS system ticks until all the keys are released, then the
+ * any key interrupt is armed again. The key events are put in a type ahead queue
+ * of KEYPAD_QUEUE_SIZE events (a power of two, one place is kept empty), an event
+ * is dropped if the queue is full. 16 holds a password and ENTER typed while the
+ * application is busy, a press and a release for every key. KEYPAD_tick runs in a
+ * task, a task that takes longer than a tick delays the scan and the ticks it
+ * covers count as one
+ */
+#define KEYPAD_SCAN_TICKS                2
+#define KEYPAD_SCAN_PERIOD_MS            (KEYPAD_SCAN_TICKS * TIMER_SYSCLK_TICK_MS)
+#define KEYPAD_QUEUE_SIZE                16
+
+/*
+ * Debounce and hold times in milliseconds, rounded up to whole scans:
+ * a key is pressed or released when the scans agree for KEYPAD_DEBOUNCE_MS.
+ * A held key repeats after KEYPAD_REPEAT_DELAY_MS then every KEYPAD_REPEAT_PERIOD_MS,
+ * and is long pressed once after KEYPAD_LONG_PRESS_MS
+ */
+#define KEYPAD_DEBOUNCE_MS               20
+#define KEYPAD_REPEAT_DELAY_MS           500
+#define KEYPAD_REPEAT_PERIOD_MS          100
+#define KEYPAD_LONG_PRESS_MS             1000
+
+#define KEYPAD_MS_TO_SCANS(MS)           (((MS) + KEYPAD_SCAN_PERIOD_MS - 1) / KEYPAD_SCAN_PERIOD_MS)
+#define KEYPAD_DEBOUNCE_SCANS            KEYPAD_MS_TO_SCANS(KEYPAD_DEBOUNCE_MS)
+#define KEYPAD_REPEAT_DELAY_SCANS        KEYPAD_MS_TO_SCANS(KEYPAD_REPEAT_DELAY_MS)
+#define KEYPAD_REPEAT_PERIOD_SCANS       KEYPAD_MS_TO_SCANS(KEYPAD_REPEAT_PERIOD_MS)
+#define KEYPAD_LONG_PRESS_SCANS          KEYPAD_MS_TO_SCANS(KEYPAD_LONG_PRESS_MS)
+
+#if ((KEYPAD_LONG_PRESS_SCANS > 255) || (KEYPAD_REPEAT_DELAY_SCANS > 255) || (KEYPAD_REPEAT_PERIOD_SCANS > 255))
+#error "The keypad hold times must fit 255 scans"
+#endif
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef enum
+{
+	KEYPAD_EVENT_PRESS, KEYPAD_EVENT_RELEASE, KEYPAD_EVENT_REPEAT, KEYPAD_EVENT_LONG_PRESS
+}KEYPAD_EventKindType;
+
+typedef struct
+{
+	uint8 key;
+	KEYPAD_EventKindType kind;
+}KEYPAD_EventType;
+
 /*------------------------------------------------------------------------------
  *  							Function Declarations
  *----------------------------------------------------------------------------*/
 
 /*
  * Description :
- * Get the Keypad pressed button
+ * Start the background scanner with an empty event queue
+ */
+void KEYPAD_init(void);
+
+/*
+ * Description :
+ * Get the Keypad pressed button, waits until the scanner queues a press
  */
 uint8 KEYPAD_getPressedKey(void);
 
+/*
+ * Description :
+ * Take the oldest key event from the queue without waiting.
+ * Returns FALSE if the queue is empty
+ */
+boolean KEYPAD_getEvent(KEYPAD_EventType *a_event);
+
+/*
+ * Description :
+ * Drop all the queued events, call it when the screen changes so the keys typed
+ * for the old screen are not used by the new one
+ */
+void KEYPAD_flush(void);
+
+/*
+ * Description :
+ * Set the function called from KEYPAD_tick every time an event is queued
+ */
+void KEYPAD_setCallBack(void(*a_ptr)(void));
+
+/*
+ * Description :
+ * Scan the keypad if a key is held, call it from a task after every system tick
+ * (a task waiting on SCHED_EVENT_TICK)
+ */
+void KEYPAD_tick(void);
+
+/*
+ * Description :
+ * Scan all the keypad rows once and return the pressed button without waiting,
+ * KEYPAD_NO_KEY if no button is pressed, KEYPAD_MULTI_KEY or KEYPAD_GHOST_KEY.
+ * The background scanner uses it, do not call it while the scanner is started
+ */
+uint8 KEYPAD_readKey(void);
+
+/*
+ * Description :
+ * Scan all the keypad rows once, reading all the columns of a row at once, and
+ * return the pressed buttons as KEYPAD_MATRIX_BIT bits
+ */
+uint16 KEYPAD_readMatrix(void);
+
+/*
+ * Description :
+ * Return TRUE if the pressed buttons of a_matrix may be ghosts: two rows that share
+ * two columns close a loop, so any corner of it reads pressed if the other three are
+ */
+boolean KEYPAD_isGhosted(uint16 a_matrix);
+
+/*
+ * Description :
+ * Return the buttons pressed in the last scan of the background scanner
+ */
+uint16 KEYPAD_getMatrix(void);
+
+/*
+ * Description :
+ * Set up the any key interrupt, a_ptr is called from it when a key is pressed
+ * after KEYPAD_armAnyKey
+ */
+void KEYPAD_enableAnyKey(void(*a_ptr)(void));
+
+/*
+ * Description :
+ * Drive all the rows so the next pressed key makes the any key interrupt,
+ * call it when KEYPAD_readKey returns KEYPAD_NO_KEY since scanning releases the rows
+ */
+void KEYPAD_armAnyKey(void);
+
+/*
+ * Description :
+ * Get ready for a sleep mode that stops the I/O clock, INT0 does not see edges
+ * without it so the any key interrupt senses the low level instead.
+ * Returns FALSE without changing anything while a key is being scanned
+ */
+boolean KEYPAD_armWake(void);
+
+/*
+ * Description :
+ * Call after waking up, the any key interrupt senses the edges again. If a key
+ * woke the CPU, the time from now to its press event is measured
+ */
+void KEYPAD_disarmWake(void);
+
+/*
+ * Description :
+ * Return the time in microseconds from the last wake up by a key to its press
+ * event, the oscillator start up time before the CPU runs is not included
+ */
+uint32 KEYPAD_getWakeLatency(void);
+
 #endif /* KEYPAD_H_ */
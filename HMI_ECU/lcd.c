@@ -6,9 +6,234 @@
  *----------------------------------------------------------------------------*/
 
 #include <util/delay.h> /* For the delay functions */
+#include <avr/cpufunc.h> /* For _NOP */
+#include <avr/pgmspace.h> /* For pgm_read_byte */
 #include "common_macros.h" /* For GET_BIT Macro */
 #include "lcd.h"
 #include "gpio.h"
+#include "timer.h" /* For Timer_getMicros */
+#include <string.h> /* For memset */
+
+/* Busy flag, the bit 7 read with RS=0 R/W=1 */
+#define LCD_BUSY_FLAG_BIT              7
+
+/* Clear display (0x01) and return home (0x02, 0x03) are the slow commands */
+#define LCD_IS_SLOW_COMMAND(COMMAND)   ((COMMAND) <= (LCD_GO_TO_HOME | 1))
+
+/*
+ * The LCD starts in 8 bits mode. In 4 bits mode it is switched by the upper halves of
+ * function sets, 8 bits three times to be sure of the mode then 4 bits (datasheet figure 24)
+ */
+#define LCD_INIT_EIGHT_BITS_NIBBLE     0x3
+#define LCD_INIT_FOUR_BITS_NIBBLE      0x2
+#define LCD_INIT_FIRST_WAIT_US         4100
+#define LCD_INIT_SECOND_WAIT_US        100
+
+/* The address counter of the LCD is not known, after a command from the application */
+#define LCD_ADDRESS_UNKNOWN            0xFF
+
+#if (LCD_ROWS > 4)
+#error "LCD_ROWS can be 4 at most"
+#endif
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * The text of the screen written by the application, and the text the LCD shows.
+ * A cell written twice, or cleared then written back, is compared to what is shown
+ */
+static uint8 g_frame[LCD_ROWS][LCD_COLS];
+static uint8 g_shown[LCD_ROWS][LCD_COLS];
+
+/* Cursor of the framebuffer, where the next character is written */
+static uint8 g_cursorRow = 0;
+static uint8 g_cursorCol = 0;
+
+/* Display memory address the LCD writes the next character to */
+static uint8 g_lcdAddress = LCD_ADDRESS_UNKNOWN;
+
+#ifndef LCD_RW_PIN
+/*
+ * Time of the last write of LCD_refresh and its execution time, the LCD is busy
+ * until it passed. The blocking writes wait their whole time and leave it 0
+ */
+static uint32 g_writeMicros = 0;
+static uint16 g_writeTimeUs = 0;
+#endif
+
+/*------------------------------------------------------------------------------
+ *  							Private Functions
+ *----------------------------------------------------------------------------*/
+
+#if (LCD_DATA_BITS_MODE == 4)
+/*
+ * Description :
+ * Put a_nibble on D4 - D7 and pulse E, the LCD takes it when E falls. Setting the
+ * four pins takes longer than the 500ns E cycle time (tcycE) between two halves
+ */
+static void LCD_writeNibble(uint8 a_nibble)
+{
+	GPIO_PIN_WRITE(LCD_DB4_PIN, GET_BIT(a_nibble, 0));
+	GPIO_PIN_WRITE(LCD_DB5_PIN, GET_BIT(a_nibble, 1));
+	GPIO_PIN_WRITE(LCD_DB6_PIN, GET_BIT(a_nibble, 2));
+	GPIO_PIN_WRITE(LCD_DB7_PIN, GET_BIT(a_nibble, 3));
+	GPIO_PIN_HIGH(LCD_E_PIN);
+	_NOP();
+	GPIO_PIN_LOW(LCD_E_PIN);
+}
+#endif
+
+/*
+ * Description :
+ * Make the data pins outputs, or inputs without pull ups so the LCD can drive them
+ */
+static void LCD_setBusOutput(boolean a_output)
+{
+#if (LCD_DATA_BITS_MODE == 4)
+	if(a_output)
+	{
+		GPIO_PIN_OUTPUT(LCD_DB4_PIN);
+		GPIO_PIN_OUTPUT(LCD_DB5_PIN);
+		GPIO_PIN_OUTPUT(LCD_DB6_PIN);
+		GPIO_PIN_OUTPUT(LCD_DB7_PIN);
+	}
+	else
+	{
+		GPIO_PIN_INPUT(LCD_DB4_PIN);
+		GPIO_PIN_INPUT(LCD_DB5_PIN);
+		GPIO_PIN_INPUT(LCD_DB6_PIN);
+		GPIO_PIN_INPUT(LCD_DB7_PIN);
+		GPIO_PIN_LOW(LCD_DB4_PIN);
+		GPIO_PIN_LOW(LCD_DB5_PIN);
+		GPIO_PIN_LOW(LCD_DB6_PIN);
+		GPIO_PIN_LOW(LCD_DB7_PIN);
+	}
+#else
+	if(a_output)
+	{
+		GPIO_DDR(LCD_DATA_PORT) = PORT_OUTPUT;
+	}
+	else
+	{
+		GPIO_PORT(LCD_DATA_PORT) = 0;
+		GPIO_DDR(LCD_DATA_PORT) = PORT_INPUT;
+	}
+#endif
+}
+
+/*
+ * Description :
+ * Return TRUE while the LCD executes the last instruction. With the R/W pin the busy
+ * flag is read once with the data port as input, the data bus is valid 160ns after
+ * E rises (tDDR). Without it the execution time of the last write is compared to the
+ * time passed since it
+ */
+static boolean LCD_isBusy(void)
+{
+#ifdef LCD_RW_PIN
+	uint8 busy;
+
+	/* Release the bus before the LCD drives it */
+	LCD_setBusOutput(FALSE);
+	GPIO_PIN_LOW(LCD_RS_PIN);
+	GPIO_PIN_HIGH(LCD_RW_PIN);
+
+	GPIO_PIN_HIGH(LCD_E_PIN);
+	_NOP(); /* tDDR and the input synchronizer */
+	_NOP();
+#if (LCD_DATA_BITS_MODE == 4)
+	busy = GPIO_PIN_READ(LCD_DB7_PIN); /* The upper half comes first */
+	GPIO_PIN_LOW(LCD_E_PIN);
+
+	/* The lower half of the address must be read too to end the read */
+	GPIO_PIN_HIGH(LCD_E_PIN);
+	_NOP();
+	GPIO_PIN_LOW(LCD_E_PIN);
+#else
+	busy = GET_BIT(GPIO_PIN(LCD_DATA_PORT), LCD_BUSY_FLAG_BIT);
+	GPIO_PIN_LOW(LCD_E_PIN);
+#endif
+
+	GPIO_PIN_LOW(LCD_RW_PIN);
+	LCD_setBusOutput(TRUE);
+
+	return busy;
+#else
+	return ((Timer_getMicros() - g_writeMicros) < g_writeTimeUs);
+#endif
+}
+
+/*
+ * Description :
+ * Wait until the LCD finished the last instruction. A missing LCD does not hang the
+ * MCU, and without the R/W pin the wait ends after the execution time even if the
+ * system clock is not started
+ */
+static void LCD_waitReady(void)
+{
+#ifdef LCD_RW_PIN
+	uint16 polls = 0;
+
+	while(LCD_isBusy() && (polls < LCD_BUSY_MAX_POLLS))
+	{
+		polls++;
+	}
+#else
+	uint16 waited;
+
+	for(waited = 0; LCD_isBusy() && (waited < g_writeTimeUs); waited++)
+	{
+		_delay_us(1);
+	}
+	g_writeTimeUs = 0;
+#endif
+}
+
+/*
+ * Description :
+ * Write a command (RS=0) or a character (RS=1). The LCD takes the data bus when E
+ * falls, E stays high for at least 230ns (PWEH) and the data is set long before
+ */
+static void LCD_write(uint8 a_rs, uint8 a_value)
+{
+	GPIO_PIN_WRITE(LCD_RS_PIN, a_rs);
+#if (LCD_DATA_BITS_MODE == 4)
+	LCD_writeNibble(a_value >> 4);
+	LCD_writeNibble(a_value & 0x0F);
+#else
+	GPIO_PORT(LCD_DATA_PORT) = a_value;
+	GPIO_PIN_HIGH(LCD_E_PIN);
+	_NOP();
+	GPIO_PIN_LOW(LCD_E_PIN);
+#endif
+}
+
+/*
+ * Description :
+ * Display memory address of the first column of a row
+ */
+static uint8 LCD_rowAddress(uint8 a_row)
+{
+	uint8 lcd_memory_address = 0;
+
+	/* Calculate the required address in the LCD DDRAM */
+	switch(a_row)
+	{
+		case 1:
+			lcd_memory_address = 0x40;
+			break;
+		case 2:
+			lcd_memory_address = 0x10;
+			break;
+		case 3:
+			lcd_memory_address = 0x50;
+			break;
+	}
+
+	return lcd_memory_address;
+}
 
 /*------------------------------------------------------------------------------
  *  							Function Definitions
@@ -18,23 +243,50 @@
  * Description :
  * Initialize the LCD:
  * 1. Setup the LCD pins directions by use the GPIO driver.
- * 2. Setup the LCD Data Mode 8-bits.
+ * 2. Setup the LCD Data Mode 4-bits or 8-bits as LCD_DATA_BITS_MODE.
  */
 void LCD_init(void)
 {
 	/* Configure the direction for RS and E pins as output pins */
-	GPIO_setupPinDirection(LCD_RS_PORT_ID,LCD_RS_PIN_ID,PIN_OUTPUT);
-	GPIO_setupPinDirection(LCD_E_PORT_ID,LCD_E_PIN_ID,PIN_OUTPUT);
+	GPIO_PIN_OUTPUT(LCD_RS_PIN);
+	GPIO_PIN_OUTPUT(LCD_E_PIN);
+#ifdef LCD_RW_PIN
+	GPIO_PIN_LOW(LCD_RW_PIN); /* Write mode R/W=0 */
+	GPIO_PIN_OUTPUT(LCD_RW_PIN);
+#endif
 
-	/* Configure the data port as output port */
-	GPIO_setupPortDirection(LCD_DATA_PORT_ID,PORT_OUTPUT);
+	/* Configure the data pins as output pins */
+	LCD_setBusOutput(TRUE);
 
-	_delay_ms(20);		/* LCD Power ON delay always > 15ms */
+	_delay_ms(20);		/* LCD Power ON delay always > 15ms, the busy flag is valid after it */
 
+#if (LCD_DATA_BITS_MODE == 4)
+	/* The busy flag can not be read before the LCD is in 4-bits mode, wait the times of the datasheet */
+	GPIO_PIN_LOW(LCD_RS_PIN);
+	LCD_writeNibble(LCD_INIT_EIGHT_BITS_NIBBLE);
+	_delay_us(LCD_INIT_FIRST_WAIT_US);
+	LCD_writeNibble(LCD_INIT_EIGHT_BITS_NIBBLE);
+	_delay_us(LCD_INIT_SECOND_WAIT_US);
+	LCD_writeNibble(LCD_INIT_EIGHT_BITS_NIBBLE);
+	_delay_us(LCD_COMMAND_TIME_US);
+	LCD_writeNibble(LCD_INIT_FOUR_BITS_NIBBLE);
+	_delay_us(LCD_COMMAND_TIME_US);
+
+	/* use 2-lines LCD + 4-bits Data Mode + 5*7 dot display Mode */
+	LCD_sendCommand(LCD_TWO_LINES_FOUR_BITS_MODE);
+#else
 	/* use 2-lines LCD + 8-bits Data Mode + 5*7 dot display Mode */
 	LCD_sendCommand(LCD_TWO_LINES_EIGHT_BITS_MODE);
+#endif
 	LCD_sendCommand(LCD_CURSOR_OFF); /* cursor off */
 	LCD_sendCommand(LCD_CLEAR_COMMAND); /* clear LCD at the beginning */
+
+	/* The framebuffer starts as the cleared screen */
+	memset(g_frame, ' ', sizeof(g_frame));
+	memset(g_shown, ' ', sizeof(g_shown));
+	g_cursorRow = 0;
+	g_cursorCol = 0;
+	g_lcdAddress = 0;
 }
 
 /*
@@ -43,14 +295,21 @@ void LCD_init(void)
  */
 void LCD_sendCommand(uint8 command)
 {
-	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,LOGIC_LOW); /* Instruction Mode RS=0 */
-	_delay_ms(1); /* delay for processing Tas = 50ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-	GPIO_writePort(LCD_DATA_PORT_ID,command); /* out the required command to the data bus D0 --> D7 */
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
+	LCD_waitReady(); /* LCD_refresh may have just written */
+	LCD_write(LOGIC_LOW, command); /* Instruction Mode RS=0 */
+	g_lcdAddress = LCD_ADDRESS_UNKNOWN;
+
+#ifndef LCD_RW_PIN
+	/* Wait for the command to finish, the busy flag can not be read */
+	if(LCD_IS_SLOW_COMMAND(command))
+	{
+		_delay_us(LCD_CLEAR_TIME_US);
+	}
+	else
+	{
+		_delay_us(LCD_COMMAND_TIME_US);
+	}
+#endif
 }
 
 /*
@@ -59,14 +318,13 @@ void LCD_sendCommand(uint8 command)
  */
 void LCD_displayCharacter(uint8 data)
 {
-	GPIO_writePin(LCD_RS_PORT_ID,LCD_RS_PIN_ID,LOGIC_HIGH); /* Data Mode RS=1 */
-	_delay_ms(1); /* delay for processing Tas = 50ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_HIGH); /* Enable LCD E=1 */
-	_delay_ms(1); /* delay for processing Tpw - Tdws = 190ns */
-	GPIO_writePort(LCD_DATA_PORT_ID,data); /* out the required command to the data bus D0 --> D7 */
-	_delay_ms(1); /* delay for processing Tdsw = 100ns */
-	GPIO_writePin(LCD_E_PORT_ID,LCD_E_PIN_ID,LOGIC_LOW); /* Disable LCD E=0 */
-	_delay_ms(1); /* delay for processing Th = 13ns */
+	if((g_cursorRow >= LCD_ROWS) || (g_cursorCol >= LCD_COLS))
+	{
+		return;
+	}
+
+	g_frame[g_cursorRow][g_cursorCol] = data;
+	g_cursorCol++;
 }
 
 /*
@@ -89,26 +347,8 @@ void LCD_displayString(const char *Str)
  */
 void LCD_moveCursor(uint8 row,uint8 col)
 {
-	uint8 lcd_memory_address;
-	
-	/* Calculate the required address in the LCD DDRAM */
-	switch(row)
-	{
-		case 0:
-			lcd_memory_address=col;
-				break;
-		case 1:
-			lcd_memory_address=col+0x40;
-				break;
-		case 2:
-			lcd_memory_address=col+0x10;
-				break;
-		case 3:
-			lcd_memory_address=col+0x50;
-				break;
-	}					
-	/* Move the LCD cursor to this specific address */
-	LCD_sendCommand(lcd_memory_address | LCD_SET_CURSOR_LOCATION);
+	g_cursorRow = row;
+	g_cursorCol = col;
 }
 
 /*
@@ -121,6 +361,31 @@ void LCD_displayStringRowColumn(uint8 row,uint8 col,const char *Str)
 	LCD_displayString(Str); /* display the string */
 }
 
+/*
+ * Description :
+ * Display the required string stored in flash on the screen
+ */
+void LCD_displayString_P(const char *Str)
+{
+	uint8 character;
+
+	while((character = pgm_read_byte(Str)) != '\0')
+	{
+		LCD_displayCharacter(character);
+		Str++;
+	}
+}
+
+/*
+ * Description :
+ * Display the required string stored in flash in a specified row and column index on the screen
+ */
+void LCD_displayStringRowColumn_P(uint8 row,uint8 col,const char *Str)
+{
+	LCD_moveCursor(row,col); /* go to to the required LCD position */
+	LCD_displayString_P(Str); /* display the string */
+}
+
 /*
  * Description :
  * Display the required decimal value on the screen
@@ -138,5 +403,72 @@ void LCD_intgerToString(int data)
  */
 void LCD_clearScreen(void)
 {
-	LCD_sendCommand(LCD_CLEAR_COMMAND); /* Send clear display command */
+	memset(g_frame, ' ', sizeof(g_frame));
+	g_cursorRow = 0;
+	g_cursorCol = 0;
+}
+
+/*
+ * Description :
+ * Send one write of the changes of the framebuffer if the LCD is ready: the address
+ * of the next changed character when the LCD is not already at it, else the character.
+ * The LCD address moves by itself after every character, so consecutive changed
+ * characters need no address. Returns TRUE until all the changes are sent
+ */
+boolean LCD_refresh(void)
+{
+	uint8 row, col, address;
+
+	if(LCD_isBusy())
+	{
+		return TRUE;
+	}
+
+	for(row = 0; row < LCD_ROWS; row++)
+	{
+		for(col = 0; col < LCD_COLS; col++)
+		{
+			if(g_frame[row][col] == g_shown[row][col])
+			{
+				continue;
+			}
+
+			address = LCD_rowAddress(row) + col;
+			if(address != g_lcdAddress)
+			{
+				LCD_write(LOGIC_LOW, address | LCD_SET_CURSOR_LOCATION);
+				g_lcdAddress = address;
+#ifndef LCD_RW_PIN
+				g_writeTimeUs = LCD_COMMAND_TIME_US;
+#endif
+			}
+			else
+			{
+				g_shown[row][col] = g_frame[row][col];
+				LCD_write(LOGIC_HIGH, g_shown[row][col]);
+				g_lcdAddress = address + 1;
+#ifndef LCD_RW_PIN
+				g_writeTimeUs = LCD_DATA_TIME_US;
+#endif
+			}
+#ifndef LCD_RW_PIN
+			g_writeMicros = Timer_getMicros();
+#endif
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/*
+ * Description :
+ * Send all the changes of the framebuffer, waiting for the LCD between the writes
+ */
+void LCD_flush(void)
+{
+	while(LCD_refresh())
+	{
+		LCD_waitReady();
+	}
 }
@@ -15,13 +15,60 @@
  *----------------------------------------------------------------------------*/
 
 /* LCD HW Ports and Pins IDs */
-#define LCD_RS_PORT_ID                 PORTC_ID
-#define LCD_RS_PIN_ID                  PIN0_ID
+#define LCD_RS_PIN                     C, 0
+#define LCD_E_PIN                      C, 1
 
-#define LCD_E_PORT_ID                  PORTC_ID
-#define LCD_E_PIN_ID                   PIN1_ID
+/*
+ * Width of the data bus, 8 or 4. In 8 bits mode D0 - D7 of the LCD are on the whole
+ * LCD_DATA_PORT. In 4 bits mode only D4 - D7 are wired, to the pins below that can be
+ * on any ports, and D0 - D3 of the LCD stay unconnected. A byte is sent as two halves
+ * back to back, the LCD executes it once like in 8 bits mode. The default pins are the
+ * upper half of PORTA as wired in 8 bits mode, PA0 - PA3 are left free.
+ * It can also be given to the compiler (-DLCD_DATA_BITS_MODE=4)
+ */
+#ifndef LCD_DATA_BITS_MODE
+#define LCD_DATA_BITS_MODE             8
+#endif
+
+#if (LCD_DATA_BITS_MODE == 4)
+#define LCD_DB4_PIN                    A, 4
+#define LCD_DB5_PIN                    A, 5
+#define LCD_DB6_PIN                    A, 6
+#define LCD_DB7_PIN                    A, 7
+#elif (LCD_DATA_BITS_MODE == 8)
+#define LCD_DATA_PORT                  A
+#else
+#error "LCD_DATA_BITS_MODE must be 4 or 8"
+#endif
+
+/*
+ * Uncomment if the R/W pin of the LCD is wired to the MCU, the driver then polls the
+ * busy flag before every write. With R/W tied to ground it waits the execution times
+ * below after every write instead. PD4 keeps clear of the JTAG pins PC2 - PC5
+ */
+/* #define LCD_RW_PIN                     D, 4 */
 
-#define LCD_DATA_PORT_ID               PORTA_ID
+/*
+ * Execution times of the HD44780 at its typical 270kHz clock in microseconds, used
+ * when the busy flag can not be read. A data write also moves the address counter (tADD).
+ * Raise them for a module with a slower controller
+ */
+#define LCD_COMMAND_TIME_US            37
+#define LCD_DATA_TIME_US               (37 + 4)
+#define LCD_CLEAR_TIME_US              1520
+
+/*
+ * The busy flag is read at most this many times, a missing LCD must not hang the MCU.
+ * A poll takes at least 5 cycles, the limit is far longer than a clear display
+ */
+#define LCD_BUSY_MAX_POLLS             10000
+
+/*
+ * Size of the screen, the text is written in a framebuffer of this size and
+ * LCD_refresh or LCD_flush send the characters that changed. Up to 4 rows are supported
+ */
+#define LCD_ROWS                       2
+#define LCD_COLS                       16
 
 /* LCD Commands */
 #define LCD_CLEAR_COMMAND              0x01
@@ -40,19 +87,21 @@
  * Description :
  * Initialize the LCD:
  * 1. Setup the LCD pins directions by use the GPIO driver.
- * 2. Setup the LCD Data Mode 4-bits or 8-bits.
+ * 2. Setup the LCD Data Mode 4-bits or 8-bits as LCD_DATA_BITS_MODE.
  */
 void LCD_init(void);
 
 /*
  * Description :
- * Send the required command to the screen
+ * Send the required command to the screen at once, the framebuffer does not see it.
+ * Clear the screen with LCD_clearScreen instead of LCD_CLEAR_COMMAND
  */
 void LCD_sendCommand(uint8 command);
 
 /*
  * Description :
- * Display the required character on the screen
+ * Write the character at the cursor in the framebuffer and move the cursor right,
+ * the characters past the end of the row are dropped
  */
 void LCD_displayCharacter(uint8 data);
 
@@ -64,7 +113,7 @@ void LCD_displayString(const char *Str);
 
 /*
  * Description :
- * Move the cursor to a specified row and column index on the screen
+ * Move the cursor of the framebuffer to a specified row and column index on the screen
  */
 void LCD_moveCursor(uint8 row,uint8 col);
 
@@ -74,6 +123,19 @@ void LCD_moveCursor(uint8 row,uint8 col);
  */
 void LCD_displayStringRowColumn(uint8 row,uint8 col,const char *Str);
 
+/*
+ * Description :
+ * Display the required string stored in flash on the screen, like a string given
+ * with PSTR("...") or declared PROGMEM. It is not copied to RAM at start up
+ */
+void LCD_displayString_P(const char *Str);
+
+/*
+ * Description :
+ * Display the required string stored in flash in a specified row and column index on the screen
+ */
+void LCD_displayStringRowColumn_P(uint8 row,uint8 col,const char *Str);
+
 /*
  * Description :
  * Display the required decimal value on the screen
@@ -82,8 +144,23 @@ void LCD_intgerToString(int data);
 
 /*
  * Description :
- * Send the clear screen command
+ * Fill the framebuffer with spaces and move the cursor home. Only the characters that
+ * were not spaces are sent, the screen does not flash like with the clear command
  */
 void LCD_clearScreen(void);
 
+/*
+ * Description :
+ * Send one write of the changes of the framebuffer if the LCD is ready, it never waits
+ * for the LCD. Call it again while it returns TRUE, from a task or the main loop, to
+ * redraw the screen in the background. Returns FALSE when the LCD shows the framebuffer
+ */
+boolean LCD_refresh(void);
+
+/*
+ * Description :
+ * Send all the changes of the framebuffer, waiting for the LCD between the writes
+ */
+void LCD_flush(void);
+
 #endif /* LCD_H_ */
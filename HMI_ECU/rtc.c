@@ -0,0 +1,236 @@
+/*------------------------------------------------------------------------------
+ *  Module      : RTC Driver
+ *  File        : rtc.c
+ *  Description : Source file for the time of day and date service on the asynchronous Timer2
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "rtc.h"
+#include "timer.h"
+#include <avr/io.h> /* To use the Timer2 Registers */
+#include <avr/interrupt.h> /* For cli */
+#include <avr/sleep.h> /* For the power-save mode */
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Seconds since RTC_BASE_YEAR-01-01 00:00:00, counted by the Timer2 overflow
+ */
+static volatile uint32 g_rtcSeconds = 0;
+
+/*
+ * Part of a millisecond not added to the system clock yet after sleeping,
+ * in 1/RTC_TICKS_PER_SECOND of a millisecond
+ */
+static uint16 g_sleepRemainder = 0;
+
+static const uint8 g_monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+/*------------------------------------------------------------------------------
+ *  							Private Functions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Timer2 overflow call-back, one second has passed
+ */
+static void RTC_tick(void)
+{
+	g_rtcSeconds++;
+}
+
+static boolean RTC_isLeapYear(uint16 a_year)
+{
+	return (((a_year % 4) == 0) && (((a_year % 100) != 0) || ((a_year % 400) == 0)));
+}
+
+static uint8 RTC_daysInMonth(uint8 a_month, uint16 a_year)
+{
+	if((a_month == 2) && RTC_isLeapYear(a_year))
+	{
+		return 29;
+	}
+	return g_monthDays[a_month - 1];
+}
+
+/*
+ * Description:
+ * Return the time in 1/RTC_TICKS_PER_SECOND of a second, read without being interrupted
+ */
+static uint32 RTC_getTicks(void)
+{
+	uint8 sreg = SREG;
+	uint32 seconds;
+	uint8 counts;
+
+	cli();
+	seconds = g_rtcSeconds;
+	counts = TCNT2;
+
+	/*
+	 * If the overflow happened with the interrupts disabled its second is not counted yet
+	 */
+	if((TIFR & (1 << TOV2)) && (counts < (RTC_TICKS_PER_SECOND / 2)))
+	{
+		seconds++;
+	}
+	SREG = sreg;
+
+	return (seconds * RTC_TICKS_PER_SECOND) + counts;
+}
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Start Timer2 from the watch crystal, the time starts at RTC_BASE_YEAR-01-01 00:00:00
+ * PC6/PC7 are used by the crystal and can not be used as GPIO
+ */
+void RTC_init(void)
+{
+	Timer_ConfigType RTC_Configurations = {0, 0, TIMER_timer2, F_CPU_128_T2, MODE_normal, TIMER_CHANNEL_A, TIMER_OUTPUT_DISCONNECTED};
+
+	g_rtcSeconds = 0;
+	Timer_setCallBack(RTC_tick, TIMER_timer2);
+	Timer_initAsync(&RTC_Configurations);
+}
+
+/*
+ * Description:
+ * Set the time of day and the date, the fields must be in their ranges
+ */
+void RTC_setTime(const RTC_TimeType *a_time)
+{
+	uint32 seconds = RTC_timeToTimestamp(a_time);
+	uint8 sreg = SREG;
+
+	/*
+	 * The new second starts now, TCNT2 may still be taking a write
+	 */
+	Timer_syncAsync();
+	cli();
+	TCNT2 = 0;
+	TIFR = 1 << TOV2;
+	g_rtcSeconds = seconds;
+	SREG = sreg;
+
+	Timer_syncAsync();
+}
+
+/*
+ * Description:
+ * Read the time of day and the date
+ */
+void RTC_getTime(RTC_TimeType *a_time)
+{
+	RTC_timestampToTime(RTC_getTimestamp(), a_time);
+}
+
+/*
+ * Description:
+ * Return the seconds since RTC_BASE_YEAR-01-01 00:00:00, a small time stamp to store
+ */
+uint32 RTC_getTimestamp(void)
+{
+	return RTC_getTicks() / RTC_TICKS_PER_SECOND;
+}
+
+/*
+ * Description:
+ * Convert the time of day and date to a time stamp
+ */
+uint32 RTC_timeToTimestamp(const RTC_TimeType *a_time)
+{
+	uint32 days = a_time->day - 1;
+	uint16 year;
+	uint8 month;
+
+	for(year = RTC_BASE_YEAR; year < a_time->year; year++)
+	{
+		days += RTC_isLeapYear(year) ? 366 : 365;
+	}
+	for(month = 1; month < a_time->month; month++)
+	{
+		days += RTC_daysInMonth(month, a_time->year);
+	}
+
+	return (days * 86400UL) + (a_time->hour * 3600UL) + (a_time->minute * 60U) + a_time->second;
+}
+
+/*
+ * Description:
+ * Convert a time stamp to the time of day and date
+ */
+void RTC_timestampToTime(uint32 a_timestamp, RTC_TimeType *a_time)
+{
+	uint32 days = a_timestamp / 86400UL;
+	uint32 seconds = a_timestamp % 86400UL;
+	uint16 yearDays;
+	uint8 monthDays;
+
+	a_time->hour = seconds / 3600;
+	a_time->minute = (seconds % 3600) / 60;
+	a_time->second = seconds % 60;
+
+	a_time->year = RTC_BASE_YEAR;
+	yearDays = RTC_isLeapYear(RTC_BASE_YEAR) ? 366 : 365;
+	while(days >= yearDays)
+	{
+		days -= yearDays;
+		a_time->year++;
+		yearDays = RTC_isLeapYear(a_time->year) ? 366 : 365;
+	}
+
+	a_time->month = 1;
+	monthDays = RTC_daysInMonth(1, a_time->year);
+	while(days >= monthDays)
+	{
+		days -= monthDays;
+		a_time->month++;
+		monthDays = RTC_daysInMonth(a_time->month, a_time->year);
+	}
+
+	a_time->day = days + 1;
+}
+
+/*
+ * Description:
+ * Sleep in power-save mode until an interrupt, the RTC keeps counting and wakes the
+ * CPU at the next second at the latest. Timer1 stops while asleep, so the time slept
+ * is added to the system clock when the CPU wakes up. It can be called with the
+ * interrupts disabled, they are enabled right before sleeping
+ */
+void RTC_sleep(void)
+{
+	uint32 before;
+	uint32 slept;
+
+	/*
+	 * Timer2 must have taken its last writes or its interrupt can not wake the CPU
+	 */
+	Timer_syncAsync();
+	before = RTC_getTicks();
+
+	/*
+	 * The instruction after sei runs before any interrupt, so an interrupt that
+	 * comes after the caller looked for work still wakes the CPU
+	 */
+	set_sleep_mode(SLEEP_MODE_PWR_SAVE);
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+
+	/*
+	 * TCNT2 reads the old value for one crystal cycle after waking up
+	 */
+	Timer_syncAsync();
+	slept = ((RTC_getTicks() - before) * 1000UL) + g_sleepRemainder;
+
+	g_sleepRemainder = slept % RTC_TICKS_PER_SECOND;
+	Timer_advanceSystemClock(slept / RTC_TICKS_PER_SECOND);
+}
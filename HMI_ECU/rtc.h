@@ -0,0 +1,95 @@
+/*------------------------------------------------------------------------------
+ *  Module      : RTC Driver
+ *  File        : rtc.h
+ *  Description : Header file for the time of day and date service on the asynchronous Timer2
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef RTC_H_
+#define RTC_H_
+
+#include "std_types.h"
+#include "timer.h"
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Timer2 counts the 32.768kHz crystal divided by 128, 256 counts per second,
+ * so it overflows exactly once every second
+ */
+#define RTC_CRYSTAL_HZ                    32768UL
+#define RTC_PRESCALER                     128
+#define RTC_TICKS_PER_SECOND              (RTC_CRYSTAL_HZ / RTC_PRESCALER)
+
+#if (RTC_TICKS_PER_SECOND != 256)
+#error "Timer2 must overflow once every second"
+#endif
+
+#if (TIMER2_OWNER != TIMER_OWNER_RTC)
+#error "The RTC needs Timer2, give TIMER2_OWNER to TIMER_OWNER_RTC"
+#endif
+
+/* Timestamps are seconds since the start of this year, dates are valid until 2135 */
+#define RTC_BASE_YEAR                     2000
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef struct {
+	uint8 second;   /* 0 - 59 */
+	uint8 minute;   /* 0 - 59 */
+	uint8 hour;     /* 0 - 23 */
+	uint8 day;      /* 1 - 31 */
+	uint8 month;    /* 1 - 12 */
+	uint16 year;    /* RTC_BASE_YEAR and after */
+} RTC_TimeType;
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Start Timer2 from the watch crystal, the time starts at RTC_BASE_YEAR-01-01 00:00:00
+ * PC6/PC7 are used by the crystal and can not be used as GPIO
+ */
+void RTC_init(void);
+
+/*
+ * Description:
+ * Set the time of day and the date, the fields must be in their ranges
+ */
+void RTC_setTime(const RTC_TimeType *a_time);
+
+/*
+ * Description:
+ * Read the time of day and the date
+ */
+void RTC_getTime(RTC_TimeType *a_time);
+
+/*
+ * Description:
+ * Return the seconds since RTC_BASE_YEAR-01-01 00:00:00, a small time stamp to store
+ */
+uint32 RTC_getTimestamp(void);
+
+/*
+ * Description:
+ * Convert between a time stamp and the time of day and date
+ */
+uint32 RTC_timeToTimestamp(const RTC_TimeType *a_time);
+void RTC_timestampToTime(uint32 a_timestamp, RTC_TimeType *a_time);
+
+/*
+ * Description:
+ * Sleep in power-save mode until an interrupt, the RTC keeps counting and wakes the
+ * CPU at the next second at the latest. Timer1 stops while asleep, so the time slept
+ * is added to the system clock when the CPU wakes up. It can be called with the
+ * interrupts disabled, they are enabled right before sleeping
+ */
+void RTC_sleep(void);
+
+#endif /* RTC_H_ */
@@ -0,0 +1,139 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Scheduler
+ *  File        : scheduler.h
+ *  Description : Header file for the cooperative run-to-completion scheduler
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "std_types.h"
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/* Maximum number of tasks, one bit of the ready mask for each task */
+#define SCHED_MAX_TASKS                   8
+
+/* Returned by SCHED_addTask when all task slots are used */
+#define SCHED_INVALID_TASK                0xFF
+
+/*
+ * Event given to a task when the time requested by SCHED_wakeAfter has passed,
+ * the application events can use the bits below SCHED_EVENT_TICK
+ */
+#define SCHED_EVENT_TIMEOUT               0x8000
+
+/*
+ * Set by the system tick (TIMER1_COMPA_HANDLER in timer.h), a task waiting on it runs
+ * once after every tick. Ticks that pass while the task waits to run are seen as one
+ */
+#define SCHED_EVENT_TICK                  0x4000
+
+/* Given to the idle hook when no task waits for a wake up time */
+#define SCHED_NO_WAKE                     0xFFFFFFFFUL
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef uint8 SCHED_TaskIdType;
+
+typedef uint16 SCHED_EventType;
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Events set (possibly from interrupts) and not given to the tasks yet,
+ * extern only for SCHED_setEventFromIsr
+ */
+extern volatile SCHED_EventType g_schedPendingEvents;
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Remove all tasks, pending events and wake up times
+ */
+void SCHED_init(void);
+
+/*
+ * Description:
+ * Add a task that is called every time it becomes ready, it must return quickly
+ * a_events is the mask of events that make the task ready when they are set.
+ * Tasks added first have the higher priority.
+ * Returns the ID of the task or SCHED_INVALID_TASK
+ */
+SCHED_TaskIdType SCHED_addTask(void (*a_task)(void), SCHED_EventType a_events);
+
+/*
+ * Description:
+ * Make the task ready to run once more, safe to call from interrupts
+ */
+void SCHED_setReady(SCHED_TaskIdType a_task_ID);
+
+/*
+ * Description:
+ * Make the task ready with SCHED_EVENT_TIMEOUT after a_ms milliseconds,
+ * a new call replaces the old wake up time
+ */
+void SCHED_wakeAfter(SCHED_TaskIdType a_task_ID, uint32 a_ms);
+
+/*
+ * Description:
+ * Cancel the wake up time of the task if it was not reached yet
+ */
+void SCHED_cancelWake(SCHED_TaskIdType a_task_ID);
+
+/*
+ * Description:
+ * Set events, every task waiting on any of them becomes ready, safe to call from interrupts
+ */
+void SCHED_setEvent(SCHED_EventType a_events);
+
+/*
+ * Description:
+ * Same as SCHED_setEvent for an ISR where the interrupts are already disabled, it is
+ * inlined so a vector bound to it calls no function and saves only a few registers
+ */
+static inline __attribute__((always_inline)) void SCHED_setEventFromIsr(SCHED_EventType a_events)
+{
+	g_schedPendingEvents |= a_events;
+}
+
+/*
+ * Description:
+ * Return the events that made the running task ready, they are cleared before it runs again
+ */
+SCHED_EventType SCHED_getEvents(void);
+
+/*
+ * Description:
+ * Return the ID of the running task or SCHED_INVALID_TASK between tasks.
+ * Before SCHED_run starts it is the task that was running at the last reset
+ */
+SCHED_TaskIdType SCHED_getRunningTask(void);
+
+/*
+ * Description:
+ * Set the function called when no task is ready, NULL_PTR for none. a_ms is the time
+ * to the nearest wake up time or SCHED_NO_WAKE. It is called with the interrupts
+ * disabled after checking that nothing is ready, to sleep it must enable them with
+ * sei() right before sleep_cpu() so an interrupt that comes in between still wakes
+ * the CPU, and it must return with the interrupts enabled
+ */
+void SCHED_setIdleHook(void (*a_ptr)(uint32 a_ms));
+
+/*
+ * Description:
+ * Run the ready tasks forever, this function never returns
+ */
+void SCHED_run(void);
+
+#endif /* SCHEDULER_H_ */
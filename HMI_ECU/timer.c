@@ -7,17 +7,34 @@
 
 #include "timer.h"
 #include "common_macros.h" /* To use the macros like SET_BIT */
+#include "gpio.h" /* For the compare output and capture pins */
 #include <avr/io.h> /* To use ICU/Timer1 Registers */
 #include <avr/interrupt.h> /* For ICU ISR */
+#include "profiler.h" /* To measure the ISRs */
+
+#ifdef TIMER_ISR_HANDLERS_HEADER
+#include TIMER_ISR_HANDLERS_HEADER /* Handlers bound to the vectors at compile time */
+#endif
 
 /*------------------------------------------------------------------------------
  *  							Global Variables
  *----------------------------------------------------------------------------*/
 
 /*
- * Array of pointers to hold the addresses of callback functions for each timer
+ * Array of pointers to hold the addresses of callback functions for each timer,
+ * the pointers themselves are volatile since the ISRs read them
+ */
+static void (*volatile g_callBackPtr[3])(void) = {NULL_PTR, NULL_PTR, NULL_PTR};
+
+/*
+ * Milliseconds counted by the system clock, updated once every system tick
  */
-static volatile void (*g_callBackPtr[3])(void) = {NULL_PTR, NULL_PTR, NULL_PTR};
+static volatile uint32 g_sysClk_ms = 0;
+
+/*
+ * The allocation table of timer.h, indexed by Timer_ID_Type
+ */
+static const uint8 g_timerOwners[3] = {TIMER0_OWNER, TIMER1_OWNER, TIMER2_OWNER};
 
 /*------------------------------------------------------------------------------
  *  							Interrupt Service Routines
@@ -25,44 +42,114 @@ static volatile void (*g_callBackPtr[3])(void) = {NULL_PTR, NULL_PTR, NULL_PTR};
 
 ISR(TIMER0_OVF_vect)
 {
+	PROFILER_ISR_ENTER(PROFILER_TIMER0_OVF);
+#ifdef TIMER0_OVF_HANDLER
+    TIMER0_OVF_HANDLER();
+#else
     if (g_callBackPtr[0] != NULL_PTR) {
         (*g_callBackPtr[0])();
     }
+#endif
+	PROFILER_ISR_EXIT(PROFILER_TIMER0_OVF);
 }
 
 ISR(TIMER0_COMP_vect)
 {
+	PROFILER_ISR_ENTER(PROFILER_TIMER0_COMP);
+#ifdef TIMER0_COMP_HANDLER
+    TIMER0_COMP_HANDLER();
+#else
     if (g_callBackPtr[0] != NULL_PTR) {
         (*g_callBackPtr[0])();
     }
+#endif
+	PROFILER_ISR_EXIT(PROFILER_TIMER0_COMP);
 }
 
 ISR(TIMER1_OVF_vect)
 {
+	PROFILER_ISR_ENTER(PROFILER_TIMER1_OVF);
+#ifdef TIMER1_OVF_HANDLER
+    TIMER1_OVF_HANDLER();
+#else
+    if (g_callBackPtr[1] != NULL_PTR) {
+        (*g_callBackPtr[1])();
+    }
+#endif
+	PROFILER_ISR_EXIT(PROFILER_TIMER1_OVF);
+}
+
+ISR(TIMER1_CAPT_vect)
+{
+	PROFILER_ISR_ENTER(PROFILER_TIMER1_CAPT);
+#ifdef TIMER1_CAPT_HANDLER
+    TIMER1_CAPT_HANDLER();
+#else
     if (g_callBackPtr[1] != NULL_PTR) {
         (*g_callBackPtr[1])();
     }
+#endif
+	PROFILER_ISR_EXIT(PROFILER_TIMER1_CAPT);
 }
 
 ISR(TIMER1_COMPA_vect)
 {
+	PROFILER_ISR_ENTER(PROFILER_TIMER1_COMPA);
+	PROFILER_ISR_LATENCY(PROFILER_TIMER1_COMPA);
+
+	/*
+	 * While the system clock owns Timer1 every compare match is one system tick
+	 */
+    g_sysClk_ms += TIMER_SYSCLK_TICK_MS;
+
+#ifdef TIMER1_COMPA_HANDLER
+    TIMER1_COMPA_HANDLER();
+#else
     if (g_callBackPtr[1] != NULL_PTR) {
         (*g_callBackPtr[1])();
     }
+#endif
+	PROFILER_ISR_EXIT(PROFILER_TIMER1_COMPA);
 }
 
 ISR(TIMER2_OVF_vect)
 {
+	PROFILER_ISR_ENTER(PROFILER_TIMER2_OVF);
+#ifdef TIMER2_OVF_HANDLER
+    TIMER2_OVF_HANDLER();
+#else
     if (g_callBackPtr[2] != NULL_PTR) {
         (*g_callBackPtr[2])();
     }
+#endif
+	PROFILER_ISR_EXIT(PROFILER_TIMER2_OVF);
 }
 
 ISR(TIMER2_COMP_vect)
 {
+	PROFILER_ISR_ENTER(PROFILER_TIMER2_COMP);
+#ifdef TIMER2_COMP_HANDLER
+    TIMER2_COMP_HANDLER();
+#else
     if (g_callBackPtr[2] != NULL_PTR) {
         (*g_callBackPtr[2])();
     }
+#endif
+	PROFILER_ISR_EXIT(PROFILER_TIMER2_COMP);
+}
+
+/*------------------------------------------------------------------------------
+ *  							Private Functions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Wait until TCNT2, OCR2 and TCCR2 took their last asynchronous write, a new write
+ * while the update busy flag of the register is set can corrupt its value
+ */
+static void Timer_waitAsync(void)
+{
+	while(ASSR & ((1 << TCN2UB) | (1 << OCR2UB) | (1 << TCR2UB)));
 }
 
 /*------------------------------------------------------------------------------
@@ -72,44 +159,90 @@ ISR(TIMER2_COMP_vect)
 /*
  * Description:
  * Function to initialize the timer with specific configurations
+ * The output pin of the channel is made an output when it is connected.
+ * a_owner is the TIMER_OWNER_ of the caller, it must be the owner of the timer in
+ * the allocation table.
+ * Returns FALSE if the timer is not given to a_owner or does not have the mode or the channel
  */
-void Timer_init(const Timer_ConfigType * Config_Ptr)
+boolean Timer_init(const Timer_ConfigType * Config_Ptr, uint8 a_owner)
 {
+	uint8 clock;
+
+	/*
+	 * The system clock and the RTC have their own start functions, Timer_init would
+	 * stop them. Any other caller must own the timer in the allocation table
+	 */
+	if((a_owner == TIMER_OWNER_SYSCLK) || (a_owner == TIMER_OWNER_RTC) ||
+	   (a_owner != g_timerOwners[Config_Ptr->timer_ID]))
+	{
+		return FALSE;
+	}
+
+	/*
+	 * The capture modes are on Timer1 only, and channel B too
+	 */
+	if((Config_Ptr->timer_ID != TIMER_timer1) &&
+	   ((Config_Ptr->timer_mode >= MODE_captureRising) || (Config_Ptr->timer_channel != TIMER_CHANNEL_A)))
+	{
+		return FALSE;
+	}
+
+	/*
+	 * This calculation is used to determine prescalar since Timer 2 and 0/1 have different values of prescalar
+	 */
+	if(Config_Ptr->timer_ID == TIMER_timer2)
+		clock = Config_Ptr->timer_clock;
+	else if(Config_Ptr->timer_clock > 5)
+		clock = Config_Ptr->timer_clock - 2;
+	else if(Config_Ptr->timer_clock > 3)
+		clock = Config_Ptr->timer_clock - 1;
+	else
+		clock = Config_Ptr->timer_clock;
+
     if (Config_Ptr->timer_ID == TIMER_timer0)
     {
         TCNT0 = Config_Ptr->timer_InitialValue;
+        OCR0 = Config_Ptr->timer_compare_MatchValue;
 
         /*
-         * This calculation is used to determine prescalar since Timer 2 and 0/1 have different values of prescalar
+         * The whole register is written so nothing is left from the mode set before
          */
-		if(Config_Ptr->timer_clock > 5)
-			TCCR0 = (Config_Ptr->timer_clock - 2) | (TCCR0 & 0xF8);
-		else if(Config_Ptr->timer_clock > 3)
-			TCCR0 = (Config_Ptr->timer_clock - 1) | (TCCR0 & 0xF8);
-		else
-			TCCR0 = (Config_Ptr->timer_clock) | (TCCR0 & 0xF8);
+        TCCR0 = clock | (Config_Ptr->timer_output << COM00);
 
-        TCCR0 |= (1 << FOC0); /* Force Output Compare for non-PWM modes */
-
-        if (Config_Ptr->timer_mode == MODE_normal)
+        switch(Config_Ptr->timer_mode)
         {
+        case MODE_normal:
         	/*
+        	 * Force Output Compare for non-PWM modes
         	 * Flag of Normal mode to 1
         	 */
-			TIMSK |= 1 << TOIE0;
-        }
-        else if (Config_Ptr->timer_mode == MODE_CTC)
-        {
+        	TCCR0 |= (1 << FOC0);
+        	TIMSK |= 1 << TOIE0;
+        	break;
+        case MODE_CTC:
         	/*
         	 * WGM01 = 1 to activate Compare mode
         	 * Flag of Compare mode to 1
-        	 * Set the OCR0 to the inputed compare value
         	 */
-        	TCCR0 |= 1 << WGM01;
-
-            OCR0 = Config_Ptr->timer_compare_MatchValue;
+        	TCCR0 |= (1 << FOC0) | (1 << WGM01);
+        	TIMSK |= 1 << OCIE0;
+        	break;
+        case MODE_fastPWM:
+        	/*
+        	 * WGM01 = 1 & WGM00 = 1 to activate fast PWM, OCR0 is the duty cycle
+        	 */
+        	TCCR0 |= (1 << WGM01) | (1 << WGM00);
+        	break;
+        case MODE_phaseCorrectPWM:
+        	TCCR0 |= (1 << WGM00);
+        	break;
+        default:
+        	break;
+        }
 
-            TIMSK |= 1 << OCIE0;
+        if(Config_Ptr->timer_output != TIMER_OUTPUT_DISCONNECTED)
+        {
+        	GPIO_setupPinDirection(PORTB_ID, PIN3_ID, PIN_OUTPUT); /* OC0 */
         }
     }
 
@@ -117,78 +250,133 @@ void Timer_init(const Timer_ConfigType * Config_Ptr)
     {
         TCNT1 = Config_Ptr->timer_InitialValue;
 
-        TCCR1A = 1 << FOC1A; /* Force Output Compare for non-PWM modes */
-
-        /*
-         * This calculation is used to determine prescalar since Timer 2 and 0/1 have different values of prescalar
-         */
-		if(Config_Ptr->timer_clock > 5)
-			TCCR1B = (Config_Ptr->timer_clock - 2) | (TCCR1B & 0xF8);
-		else if(Config_Ptr->timer_clock > 3)
-			TCCR1B = (Config_Ptr->timer_clock - 1) | (TCCR1B & 0xF8);
-		else
-			TCCR1B = (Config_Ptr->timer_clock) | (TCCR1B & 0xF8);
+        if(Config_Ptr->timer_channel == TIMER_CHANNEL_A)
+        {
+        	OCR1A = Config_Ptr->timer_compare_MatchValue;
+        	TCCR1A = Config_Ptr->timer_output << COM1A0;
+        }
+        else
+        {
+        	/*
+        	 * CTC counts up to OCR1A whatever the channel is
+        	 */
+        	OCR1A = Config_Ptr->timer_compare_MatchValue;
+        	OCR1B = Config_Ptr->timer_compare_MatchValue;
+        	TCCR1A = Config_Ptr->timer_output << COM1B0;
+        }
+        TCCR1B = clock;
 
-        if (Config_Ptr->timer_mode == MODE_normal)
+        switch(Config_Ptr->timer_mode)
         {
+        case MODE_normal:
         	/*
+        	 * Force Output Compare for non-PWM modes
         	 * Flag of Normal mode to 1
         	 */
+        	TCCR1A |= (1 << FOC1A) | (1 << FOC1B);
         	TIMSK |= 1 << TOIE1;
-        }
-        else if (Config_Ptr->timer_mode == MODE_CTC)
-        {
+        	break;
+        case MODE_CTC:
         	/*
         	 * WGM12 = 1 to activate Compare mode
         	 * Flag of Compare mode to 1
-        	 * Set the OCR1A to the inputed compare value
         	 */
-            OCR1A = Config_Ptr->timer_compare_MatchValue;
-            TIMSK |= 1 << OCIE1A;
+        	TCCR1A |= (1 << FOC1A) | (1 << FOC1B);
         	TCCR1B |= 1 << WGM12;
+        	TIMSK |= 1 << OCIE1A;
+        	break;
+        case MODE_fastPWM:
+        	/*
+        	 * WGM12 = 1 & WGM10 = 1 for the 8-bit fast PWM
+        	 */
+        	TCCR1A |= 1 << WGM10;
+        	TCCR1B |= 1 << WGM12;
+        	break;
+        case MODE_phaseCorrectPWM:
+        	TCCR1A |= 1 << WGM10;
+        	break;
+        case MODE_captureRising:
+        case MODE_captureFalling:
+        	/*
+        	 * Normal counting, ICR1 takes TCNT1 at every edge of ICP1
+        	 */
+        	if(Config_Ptr->timer_mode == MODE_captureRising)
+        	{
+        		TCCR1B |= 1 << ICES1;
+        	}
+        	GPIO_setupPinDirection(PORTD_ID, PIN6_ID, PIN_INPUT); /* ICP1 */
+        	TIFR = 1 << ICF1;
+        	TIMSK |= 1 << TICIE1;
+        	break;
+        }
+
+        if(Config_Ptr->timer_output != TIMER_OUTPUT_DISCONNECTED)
+        {
+        	GPIO_setupPinDirection(PORTD_ID, (Config_Ptr->timer_channel == TIMER_CHANNEL_A) ? PIN5_ID : PIN4_ID, PIN_OUTPUT); /* OC1A/OC1B */
         }
     }
 
     else if (Config_Ptr->timer_ID == TIMER_timer2)
     {
 		TCNT2 = Config_Ptr->timer_InitialValue;
+		OCR2 = Config_Ptr->timer_compare_MatchValue;
 
 		/*
-		 * Set PreScalar
+		 * Set PreScalar, the whole register is written so nothing is left from the mode set before
 		 */
-		TCCR2 = (Config_Ptr->timer_clock) | (TCCR0 & 0xF8);
-
-		TCCR2 |= (1 << FOC2); /* Force Output Compare for non-PWM modes */
+		TCCR2 = clock | (Config_Ptr->timer_output << COM20);
 
-		if (Config_Ptr->timer_mode == MODE_normal)
+		switch(Config_Ptr->timer_mode)
 		{
+		case MODE_normal:
 			/*
+			 * Force Output Compare for non-PWM modes
 			 * Set the Normal mode flag to 1
 			 */
+			TCCR2 |= (1 << FOC2);
 			TIMSK |= 1 << TOIE2;
-		}
-		else if (Config_Ptr->timer_mode == MODE_CTC)
-		{
+			break;
+		case MODE_CTC:
         	/*
         	 * WGM21 = 1 to activate Compare mode
         	 * Flag of Compare mode to 1
-        	 * Set the OCR2 to the inputed compare value
         	 */
-			TCCR2 |= 1 << WGM21;
-
-			OCR2 = Config_Ptr->timer_compare_MatchValue;
-
+			TCCR2 |= (1 << FOC2) | (1 << WGM21);
 			TIMSK |= 1 << OCIE2;
+			break;
+		case MODE_fastPWM:
+			TCCR2 |= (1 << WGM21) | (1 << WGM20);
+			break;
+		case MODE_phaseCorrectPWM:
+			TCCR2 |= (1 << WGM20);
+			break;
+		default:
+			break;
+		}
+
+		if(Config_Ptr->timer_output != TIMER_OUTPUT_DISCONNECTED)
+		{
+			GPIO_setupPinDirection(PORTD_ID, PIN7_ID, PIN_OUTPUT); /* OC2 */
 		}
 	}
+
+    return TRUE;
 }
 
 /*
  * Description:
  * Function to de-initialize the timer with specific configurations
+ * Returns FALSE and leaves the timer running if it is not given to a_owner, or if it is
+ * the system clock or the RTC
  */
-void Timer_deinit(Timer_ID_Type timer_type)
+boolean Timer_deinit(Timer_ID_Type timer_type, uint8 a_owner)
 {
+	if((a_owner == TIMER_OWNER_SYSCLK) || (a_owner == TIMER_OWNER_RTC) ||
+	   (a_owner != g_timerOwners[timer_type]))
+	{
+		return FALSE;
+	}
+
     if (timer_type == TIMER_timer0)
     {
         TCCR0 = 0x00;
@@ -203,8 +391,10 @@ void Timer_deinit(Timer_ID_Type timer_type)
         TCCR1B = 0x00;
         TCNT1 = 0x00;
         OCR1A = 0x00;
+        OCR1B = 0x00;
         TIMSK &= ~(1 << TOIE1);
         TIMSK &= ~(1 << OCIE1A);
+        TIMSK &= ~(1 << TICIE1);
     }
     else if (timer_type == TIMER_timer2)
     {
@@ -213,14 +403,321 @@ void Timer_deinit(Timer_ID_Type timer_type)
         OCR2 = 0x00;
         TIMSK &= ~(1 << TOIE2);
         TIMSK &= ~(1 << OCIE2);
+        ASSR &= ~(1 << AS2); /* Back to the F_CPU clock if it was asynchronous */
     }
+
+    return TRUE;
 }
 
 /*
  * Description:
  * Function to set the callback function for a specific timer
+ * The vectors bound at compile time (TIMERx_<vector>_HANDLER) do not use it
  * */
 void Timer_setCallBack(void(*a_ptr)(void), Timer_ID_Type a_timer_ID)
 {
+	uint8 sreg = SREG;
+
+	/*
+	 * The pointer is two bytes, do not let the ISR see half of it while the timer runs
+	 */
+	cli();
     g_callBackPtr[a_timer_ID] = a_ptr;
+    SREG = sreg;
+}
+
+/*
+ * Description:
+ * Change the compare value (or PWM duty cycle) of a running timer channel
+ * without restarting the timer
+ */
+void Timer_setCompareValue(Timer_ID_Type a_timer_ID, Timer_ChannelType a_channel, uint16 a_value)
+{
+	uint8 sreg = SREG;
+
+	if(a_timer_ID == TIMER_timer0)
+	{
+		OCR0 = a_value;
+	}
+	else if(a_timer_ID == TIMER_timer2)
+	{
+		OCR2 = a_value;
+	}
+	else
+	{
+		/*
+		 * 16-bit registers use the shared TEMP register, an ISR must not write in between
+		 */
+		cli();
+		if(a_channel == TIMER_CHANNEL_A)
+		{
+			OCR1A = a_value;
+		}
+		else
+		{
+			OCR1B = a_value;
+		}
+		SREG = sreg;
+	}
+}
+
+/*
+ * Description:
+ * Return TCNT1 saved at the last edge of the capture modes
+ */
+uint16 Timer_getCaptureValue(void)
+{
+	uint8 sreg = SREG;
+	uint16 value;
+
+	cli();
+	value = ICR1;
+	SREG = sreg;
+
+	return value;
+}
+
+/*
+ * Description:
+ * Fill Config_Ptr with the prescaler and compare value that make the timer
+ * interrupt every a_period_us in CTC mode, the smallest prescaler with the
+ * lowest error is chosen.
+ * Returns the accuracy of the achieved period as error in parts per million,
+ * 0 means exact or TIMER_PERIOD_INVALID if the period is out of range
+ */
+uint32 Timer_calcPeriodConfig(Timer_ID_Type a_timer_ID, uint32 a_period_us, Timer_ConfigType * Config_Ptr)
+{
+	/*
+	 * Division factor of each Timer_ClockType, 0 for the clocks the timer does not have
+	 */
+	static const uint16 prescalers[2][8] = {
+		{0, 1, 8, 0,  64, 0,   256, 1024}, /* Timer0 and Timer1 */
+		{0, 1, 8, 32, 64, 128, 256, 1024}  /* Timer2 */
+	};
+	const uint16 * timerPrescalers = prescalers[(a_timer_ID == TIMER_timer2) ? 1 : 0];
+	uint32 maxCounts = (a_timer_ID == TIMER_timer1) ? 0x10000UL : 0x100UL;
+	uint32 cycles = a_period_us * (F_CPU / 1000000UL);
+	uint32 bestError = TIMER_PERIOD_INVALID;
+	uint32 counts;
+	uint32 error;
+	uint8 clock;
+
+	for(clock = F_CPU_CLOCK; clock <= F_CPU_1024; clock++)
+	{
+		if(timerPrescalers[clock] == 0)
+		{
+			continue;
+		}
+
+		/*
+		 * Round to the nearest count, the compare value is one less than the counts
+		 */
+		counts = (cycles + (timerPrescalers[clock] / 2)) / timerPrescalers[clock];
+		if((counts == 0) || (counts > maxCounts))
+		{
+			continue;
+		}
+
+		error = counts * timerPrescalers[clock];
+		error = (error > cycles) ? (error - cycles) : (cycles - error);
+		error = (error * 1000000UL) / cycles;
+
+		/*
+		 * Strictly lower error only, so the finest resolution wins a tie
+		 */
+		if(error < bestError)
+		{
+			bestError = error;
+			Config_Ptr->timer_ID = a_timer_ID;
+			Config_Ptr->timer_clock = clock;
+			Config_Ptr->timer_mode = MODE_CTC;
+			Config_Ptr->timer_InitialValue = 0;
+			Config_Ptr->timer_compare_MatchValue = counts - 1;
+			Config_Ptr->timer_channel = TIMER_CHANNEL_A;
+			Config_Ptr->timer_output = TIMER_OUTPUT_DISCONNECTED;
+		}
+	}
+
+	return bestError;
+}
+
+/*
+ * Description:
+ * Initialize Timer2 in asynchronous mode (AS2), clocked from the 32.768kHz watch
+ * crystal on TOSC1/TOSC2 (PC6/PC7) instead of F_CPU, so it keeps counting in
+ * power-save sleep. Config_Ptr is used like Timer_init, the prescaler divides the
+ * crystal frequency. Only TIMER_timer2 is accepted
+ */
+void Timer_initAsync(const Timer_ConfigType * Config_Ptr)
+{
+	uint8 control;
+	uint8 interrupts = 0;
+
+	if(Config_Ptr->timer_ID != TIMER_timer2)
+	{
+		return;
+	}
+
+	/*
+	 * The whole TCCR2 value is made first, an asynchronous register must be written
+	 * only once until its update busy flag clears or it may take a wrong value
+	 */
+	control = Config_Ptr->timer_clock | (Config_Ptr->timer_output << COM20);
+	switch(Config_Ptr->timer_mode)
+	{
+	case MODE_normal:
+		control |= (1 << FOC2);
+		interrupts = 1 << TOIE2;
+		break;
+	case MODE_CTC:
+		control |= (1 << FOC2) | (1 << WGM21);
+		interrupts = 1 << OCIE2;
+		break;
+	case MODE_fastPWM:
+		control |= (1 << WGM21) | (1 << WGM20);
+		break;
+	case MODE_phaseCorrectPWM:
+		control |= (1 << WGM20);
+		break;
+	default:
+		break;
+	}
+
+	/*
+	 * The datasheet sequence for switching the clock source:
+	 * disable the Timer2 interrupts, select the crystal, write TCNT2, OCR2 and TCCR2,
+	 * wait for their update busy flags then clear the flags the switch may have set
+	 */
+	TIMSK &= ~((1 << TOIE2) | (1 << OCIE2));
+	ASSR |= (1 << AS2);
+	Timer_waitAsync(); /* Writes made before in asynchronous mode */
+
+	TCNT2 = Config_Ptr->timer_InitialValue;
+	OCR2 = Config_Ptr->timer_compare_MatchValue;
+	TCCR2 = control;
+	Timer_waitAsync();
+
+	if(Config_Ptr->timer_output != TIMER_OUTPUT_DISCONNECTED)
+	{
+		GPIO_setupPinDirection(PORTD_ID, PIN7_ID, PIN_OUTPUT); /* OC2 */
+	}
+
+	TIFR = (1 << OCF2) | (1 << TOV2);
+	TIMSK |= interrupts;
+}
+
+/*
+ * Description:
+ * Wait until the asynchronous Timer2 has taken the last register writes. Call it before
+ * power-save sleep so the Timer2 interrupt can wake the CPU, and after waking up
+ * before reading TCNT2
+ */
+void Timer_syncAsync(void)
+{
+	/*
+	 * Writing OCR2 again makes the wait last at least one crystal cycle,
+	 * as the datasheet asks for before sleeping again and reading TCNT2.
+	 * OCR2 is rewritten only once the last write to it is taken
+	 */
+	Timer_waitAsync();
+	OCR2 = OCR2;
+	Timer_waitAsync();
+}
+
+/*
+ * Description:
+ * Start the free running system clock on Timer1, it must not be re-initialized
+ * by Timer_init/Timer_deinit afterwards. The Timer1 callback, if any, is called every
+ * system tick (TIMER_SYSCLK_TICK_MS)
+ */
+void Timer_startSystemClock(void)
+{
+	g_sysClk_ms = 0;
+	TCNT1 = 0;
+
+	/*
+	 * CTC mode with OCR1A as TOP, no output pins
+	 * CS11 = 1 for F_CPU/8 so each count is 1/TIMER_SYSCLK_COUNTS_PER_US microseconds
+	 */
+	OCR1A = TIMER_SYSCLK_TOP;
+	TCCR1A = 1 << FOC1A;
+	TCCR1B = (1 << WGM12) | (1 << CS11);
+
+	/*
+	 * Clear any old compare flag then enable the compare interrupt only
+	 */
+	TIFR = 1 << OCF1A;
+	TIMSK = (TIMSK & ~(1 << TOIE1)) | (1 << OCIE1A);
+}
+
+/*
+ * Description:
+ * Return the milliseconds passed since Timer_startSystemClock, wraps after ~49 days
+ * Safe to call from the application and from interrupts
+ */
+uint32 Timer_getMillis(void)
+{
+	uint32 ms;
+	uint16 counts;
+	uint8 sreg = SREG;
+
+	/*
+	 * Read the counter and TCNT1 together without being interrupted
+	 */
+	cli();
+	ms = g_sysClk_ms;
+	counts = TCNT1;
+
+	/*
+	 * The compare match may have happened after disabling the interrupts,
+	 * if TCNT1 already wrapped around then the tick was not counted yet
+	 */
+	if(BIT_IS_SET(TIFR, OCF1A) && (counts < (TIMER_SYSCLK_TOP / 2)))
+	{
+		ms += TIMER_SYSCLK_TICK_MS;
+	}
+	SREG = sreg;
+
+	return ms + (counts / (1000UL * TIMER_SYSCLK_COUNTS_PER_US));
+}
+
+/*
+ * Description:
+ * Return the microseconds passed since Timer_startSystemClock, wraps after ~71 minutes
+ * so it is meant for measuring short intervals (newer - older)
+ * Safe to call from the application and from interrupts
+ */
+uint32 Timer_getMicros(void)
+{
+	uint32 ms;
+	uint16 counts;
+	uint8 sreg = SREG;
+
+	/*
+	 * Same atomic read as Timer_getMillis
+	 */
+	cli();
+	ms = g_sysClk_ms;
+	counts = TCNT1;
+	if(BIT_IS_SET(TIFR, OCF1A) && (counts < (TIMER_SYSCLK_TOP / 2)))
+	{
+		ms += TIMER_SYSCLK_TICK_MS;
+	}
+	SREG = sreg;
+
+	return (ms * 1000UL) + (counts / TIMER_SYSCLK_COUNTS_PER_US);
+}
+
+/*
+ * Description:
+ * Add a_ms to the system clock, used after sleep modes that stop Timer1
+ * to account for the time the CPU was asleep
+ */
+void Timer_advanceSystemClock(uint32 a_ms)
+{
+	uint8 sreg = SREG;
+
+	cli();
+	g_sysClk_ms += a_ms;
+	SREG = sreg;
 }
@@ -10,6 +10,88 @@
 
 #include "std_types.h"
 
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Timer allocation table:
+ * Each timer is given to one driver here and every driver checks at build time
+ * that the timer it uses is given to it, so moving a driver to a timer that is
+ * already taken fails to build instead of silently breaking the other driver.
+ * Timer_init and Timer_deinit take the owner of the caller and refuse a timer given
+ * to another owner. TIMER_OWNER_APP is for timers the application configures with
+ * Timer_init, the system clock and the RTC are started by their own functions only
+ */
+#define TIMER_OWNER_NONE                  0
+#define TIMER_OWNER_SYSCLK                1
+#define TIMER_OWNER_RTC                   2
+#define TIMER_OWNER_PWM                   3
+#define TIMER_OWNER_APP                   4
+
+#define TIMER0_OWNER                      TIMER_OWNER_NONE /* Not used */
+#define TIMER1_OWNER                      TIMER_OWNER_SYSCLK /* 16-bit, needed by the system clock */
+#define TIMER2_OWNER                      TIMER_OWNER_RTC /* The only timer with the asynchronous crystal clock */
+
+/* Owner of the timer number NUM (0, 1 or 2), usable in #if */
+#define TIMER_OWNER_OF(NUM)               TIMER_OWNER_OF_(NUM)
+#define TIMER_OWNER_OF_(NUM)              TIMER##NUM##_OWNER
+
+/*
+ * System clock configurations:
+ * Timer1 is kept running in CTC mode with F_CPU/8, every compare match adds
+ * TIMER_SYSCLK_TICK_MS to the millisecond counter and TCNT1 is used to
+ * interpolate the microseconds in between, so the ISR runs only once per tick
+ */
+#define TIMER_SYSCLK_TICK_MS              10
+#define TIMER_SYSCLK_COUNTS_PER_US        (F_CPU / 8000000UL)
+#define TIMER_SYSCLK_TOP                  ((TIMER_SYSCLK_TICK_MS * 1000UL * TIMER_SYSCLK_COUNTS_PER_US) - 1)
+#define TIMER_SYSCLK_TICKS_PER_SECOND     (1000 / TIMER_SYSCLK_TICK_MS)
+
+#if ((F_CPU % 8000000UL) != 0)
+#error "System clock needs F_CPU to be a multiple of 8MHz to count whole microseconds"
+#endif
+
+#if (TIMER_SYSCLK_TOP > 0xFFFF)
+#error "TIMER_SYSCLK_TICK_MS is too long for the 16-bit Timer1"
+#endif
+
+#if ((1000 % TIMER_SYSCLK_TICK_MS) != 0)
+#error "TIMER_SYSCLK_TICK_MS must divide one second to keep durations exact"
+#endif
+
+#if (TIMER1_OWNER != TIMER_OWNER_SYSCLK)
+#error "The system clock needs Timer1, give TIMER1_OWNER to TIMER_OWNER_SYSCLK"
+#endif
+
+/* Returned by Timer_calcPeriodConfig when no prescaler can reach the period */
+#define TIMER_PERIOD_INVALID              0xFFFFFFFFUL
+
+/*
+ * Compile time binding of the timer interrupts:
+ * Define TIMERx_<vector>_HANDLER() as the statement that the vector runs directly
+ * instead of reading g_callBackPtr and making an indirect call. Since the compiler
+ * sees the whole handler, the ISR only saves the registers the handler uses, as long
+ * as it calls no function: any call makes the ISR save all the call clobbered registers.
+ * The statement must be a macro or a call to a static inline function marked
+ * __attribute__((always_inline)) (the Debug build is -O0), declared in the header
+ * named by TIMER_ISR_HANDLERS_HEADER, longer work goes in a task woken by an event.
+ * Define it empty to run no handler at all.
+ * Timer_setCallBack has no effect on the vectors bound here.
+ * Counted by the ISR model of Host_Sim (isr_cost, isr_cost_call) for the system tick:
+ * 36 cycles bound to SCHED_setEventFromIsr, 92 bound to the out of line KEYPAD_tick or
+ * dispatched through g_callBackPtr. The model counts the interrupt response, the
+ * prologue and epilogue, the calls and RETI, not the instructions of the body
+ */
+#define TIMER_ISR_HANDLERS_HEADER         "scheduler.h"
+/* #define TIMER0_OVF_HANDLER() */
+/* #define TIMER0_COMP_HANDLER() */
+/* #define TIMER1_OVF_HANDLER() */
+/* #define TIMER1_CAPT_HANDLER() */
+#define TIMER1_COMPA_HANDLER()            SCHED_setEventFromIsr(SCHED_EVENT_TICK) /* The keypad task scans after it */
+/* #define TIMER2_OVF_HANDLER() */
+/* #define TIMER2_COMP_HANDLER() */
+
 /*------------------------------------------------------------------------------
  *  							Data Types Declarations
  *----------------------------------------------------------------------------*/
@@ -31,17 +113,47 @@ typedef enum{
 	F_CPU_1024
 }Timer_ClockType;
 
+/*
+ * The PWM modes are 8-bit on all timers (Timer1 uses its 8-bit PWM modes),
+ * the capture modes exist on Timer1 only (ICP1 pin PD6)
+ */
 typedef enum{
     MODE_normal,
-	MODE_CTC
+	MODE_CTC,
+	MODE_fastPWM,
+	MODE_phaseCorrectPWM,
+	MODE_captureRising,
+	MODE_captureFalling
 }Timer_ModeType;
 
+/*
+ * Compare output unit of the timer, channel B exists on Timer1 only.
+ * Output pins: OC0 PB3, OC1A PD5, OC1B PD4, OC2 PD7
+ */
+typedef enum{
+	TIMER_CHANNEL_A,
+	TIMER_CHANNEL_B
+}Timer_ChannelType;
+
+/*
+ * What the compare match does to the output pin, the values are the COM bits.
+ * In the PWM modes CLEAR is non-inverting and SET is inverting PWM
+ */
+typedef enum{
+	TIMER_OUTPUT_DISCONNECTED,
+	TIMER_OUTPUT_TOGGLE,
+	TIMER_OUTPUT_CLEAR,
+	TIMER_OUTPUT_SET
+}Timer_OutputType;
+
 typedef struct {
 	uint16 timer_InitialValue;
-	uint32 timer_compare_MatchValue; /*it will be used in compare mode only*/
+	uint32 timer_compare_MatchValue; /*it will be used in compare and PWM modes (duty cycle)*/
 	Timer_ID_Type timer_ID; /*Choose timer*/
 	Timer_ClockType timer_clock; /*Prescalar for timer*/
-	Timer_ModeType timer_mode; /*Overflow or CTC mode*/
+	Timer_ModeType timer_mode; /*Overflow, CTC, PWM or capture mode*/
+	Timer_ChannelType timer_channel; /*Compare unit used by the compare and PWM modes*/
+	Timer_OutputType timer_output; /*Action on the output pin of the channel*/
 } Timer_ConfigType;
 
 /*------------------------------------------------------------------------------
@@ -51,20 +163,100 @@ typedef struct {
 /*
  * Description:
  * Function to initialize the timer with specific configurations
+ * The output pin of the channel is made an output when it is connected.
+ * a_owner is the TIMER_OWNER_ of the caller, it must be the owner of the timer in
+ * the allocation table.
+ * Returns FALSE if the timer is not given to a_owner or does not have the mode or the channel
  */
-void Timer_init(const Timer_ConfigType * Config_Ptr);
+boolean Timer_init(const Timer_ConfigType * Config_Ptr, uint8 a_owner);
 
 /*
  * Description:
  * Function to de-initialize the timer with specific configurations
+ * Returns FALSE and leaves the timer running if it is not given to a_owner, or if it is
+ * the system clock or the RTC
  */
-void Timer_deinit(Timer_ID_Type timer_type);
+boolean Timer_deinit(Timer_ID_Type timer_type, uint8 a_owner);
 
 /*
  * Description:
  * Function to set the callback function for a specific timer
+ * The vectors bound at compile time (TIMERx_<vector>_HANDLER) do not use it
  */
 void Timer_setCallBack(void(*a_ptr)(void), Timer_ID_Type a_timer_ID);
 
+/*
+ * Description:
+ * Change the compare value (or PWM duty cycle) of a running timer channel
+ * without restarting the timer
+ */
+void Timer_setCompareValue(Timer_ID_Type a_timer_ID, Timer_ChannelType a_channel, uint16 a_value);
+
+/*
+ * Description:
+ * Return TCNT1 saved at the last edge of the capture modes
+ */
+uint16 Timer_getCaptureValue(void);
+
+/*
+ * Description:
+ * Fill Config_Ptr with the prescaler and compare value that make the timer
+ * interrupt every a_period_us in CTC mode, the smallest prescaler with the
+ * lowest error is chosen.
+ * Returns the accuracy of the achieved period as error in parts per million,
+ * 0 means exact or TIMER_PERIOD_INVALID if the period is out of range. At 8MHz:
+ *   1ms  -> Timer0 F_CPU_64 OCR0=124, Timer2 F_CPU_32_T2 OCR2=249        (exact)
+ *   1ms  -> Timer1 F_CPU_CLOCK OCR1A=7999                              (exact)
+ *   10ms -> Timer1 F_CPU_8 OCR1A=9999                                  (exact)
+ *   10ms -> Timer0/2 best is F_CPU_1024 OCR=77                         (1600ppm)
+ */
+uint32 Timer_calcPeriodConfig(Timer_ID_Type a_timer_ID, uint32 a_period_us, Timer_ConfigType * Config_Ptr);
+
+/*
+ * Description:
+ * Initialize Timer2 in asynchronous mode (AS2), clocked from the 32.768kHz watch
+ * crystal on TOSC1/TOSC2 (PC6/PC7) instead of F_CPU, so it keeps counting in
+ * power-save sleep. Config_Ptr is used like Timer_init, the prescaler divides the
+ * crystal frequency. Only TIMER_timer2 is accepted
+ */
+void Timer_initAsync(const Timer_ConfigType * Config_Ptr);
+
+/*
+ * Description:
+ * Wait until the asynchronous Timer2 has taken the last register writes. Call it before
+ * power-save sleep so the Timer2 interrupt can wake the CPU, and after waking up
+ * before reading TCNT2
+ */
+void Timer_syncAsync(void);
+
+/*
+ * Description:
+ * Start the free running system clock on Timer1, it must not be re-initialized
+ * by Timer_init/Timer_deinit afterwards. Every system tick (TIMER_SYSCLK_TICK_MS)
+ * runs TIMER1_COMPA_HANDLER if it is bound, otherwise the Timer1 callback if any
+ */
+void Timer_startSystemClock(void);
+
+/*
+ * Description:
+ * Return the milliseconds passed since Timer_startSystemClock, wraps after ~49 days
+ * Safe to call from the application and from interrupts
+ */
+uint32 Timer_getMillis(void);
+
+/*
+ * Description:
+ * Return the microseconds passed since Timer_startSystemClock, wraps after ~71 minutes
+ * so it is meant for measuring short intervals (newer - older)
+ * Safe to call from the application and from interrupts
+ */
+uint32 Timer_getMicros(void);
+
+/*
+ * Description:
+ * Add a_ms to the system clock, used after sleep modes that stop Timer1
+ * to account for the time the CPU was asleep
+ */
+void Timer_advanceSystemClock(uint32 a_ms);
 
 #endif /* TIMER_H_ */
@@ -0,0 +1,14 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : cpufunc.h
+ *  Description : CPU functions of the host build, the simulated pins have no
+ *                input synchronizer so _NOP has nothing to wait for
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef SIM_AVR_CPUFUNC_H_
+#define SIM_AVR_CPUFUNC_H_
+
+#define _NOP()
+
+#endif /* SIM_AVR_CPUFUNC_H_ */
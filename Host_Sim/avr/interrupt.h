@@ -0,0 +1,18 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : interrupt.h
+ *  Description : Interrupt macros of the host build, the ISRs become functions
+ *                that the simulator calls as vectors
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef SIM_AVR_INTERRUPT_H_
+#define SIM_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(VECTOR, ...)                  void VECTOR(void); void VECTOR(void)
+#define sei()                             (SREG |= (1 << 7))
+#define cli()                             (SREG &= (uint8_t)~(1 << 7))
+
+#endif /* SIM_AVR_INTERRUPT_H_ */
@@ -0,0 +1,255 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : io.h
+ *  Description : ATmega32 IO registers mapped onto the simulated register file
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef SIM_AVR_IO_H_
+#define SIM_AVR_IO_H_
+
+#include <stdint.h>
+
+/*
+ * Every register access goes through the simulator, it commits the previous
+ * writes with their time and charges the access in virtual cycles
+ */
+volatile uint8_t *SIM_access(uint8_t a_addr);
+volatile uint16_t *SIM_access16(uint8_t a_addr);
+
+#define _SFR_IO8(ADDR)                    (*SIM_access((ADDR) + 0x20))
+#define _SFR_IO16(ADDR)                   (*SIM_access16((ADDR) + 0x20))
+#define _BV(BIT)                          (1 << (BIT))
+
+/*------------------------------------------------------------------------------
+ *  							Registers
+ *----------------------------------------------------------------------------*/
+
+#define SREG _SFR_IO8(0x3F)
+#define GICR _SFR_IO8(0x3B)
+#define GIFR _SFR_IO8(0x3A)
+#define TIMSK _SFR_IO8(0x39)
+#define TIFR _SFR_IO8(0x38)
+#define SPMCR _SFR_IO8(0x37)
+#define TWCR _SFR_IO8(0x36)
+#define MCUCR _SFR_IO8(0x35)
+#define MCUCSR _SFR_IO8(0x34)
+#define TCCR0 _SFR_IO8(0x33)
+#define TCNT0 _SFR_IO8(0x32)
+#define OSCCAL _SFR_IO8(0x31)
+#define SFIOR _SFR_IO8(0x30)
+#define TCCR1A _SFR_IO8(0x2F)
+#define TCCR1B _SFR_IO8(0x2E)
+#define TCNT1 _SFR_IO16(0x2C)
+#define TCNT1L _SFR_IO8(0x2C)
+#define TCNT1H _SFR_IO8(0x2D)
+#define OCR1A _SFR_IO16(0x2A)
+#define OCR1B _SFR_IO16(0x28)
+#define ICR1 _SFR_IO16(0x26)
+#define TCCR2 _SFR_IO8(0x25)
+#define TCNT2 _SFR_IO8(0x24)
+#define OCR2 _SFR_IO8(0x23)
+#define OCR0 _SFR_IO8(0x3C)
+#define ASSR _SFR_IO8(0x22)
+#define WDTCR _SFR_IO8(0x21)
+#define UBRRH _SFR_IO8(0x20)
+#define UCSRC _SFR_IO8(0x20)
+#define EEAR _SFR_IO16(0x1E)
+#define EEDR _SFR_IO8(0x1D)
+#define EECR _SFR_IO8(0x1C)
+#define PORTA _SFR_IO8(0x1B)
+#define DDRA _SFR_IO8(0x1A)
+#define PINA _SFR_IO8(0x19)
+#define PORTB _SFR_IO8(0x18)
+#define DDRB _SFR_IO8(0x17)
+#define PINB _SFR_IO8(0x16)
+#define PORTC _SFR_IO8(0x15)
+#define DDRC _SFR_IO8(0x14)
+#define PINC _SFR_IO8(0x13)
+#define PORTD _SFR_IO8(0x12)
+#define DDRD _SFR_IO8(0x11)
+#define PIND _SFR_IO8(0x10)
+#define SPDR _SFR_IO8(0x0F)
+#define SPSR _SFR_IO8(0x0E)
+#define SPCR _SFR_IO8(0x0D)
+#define UDR _SFR_IO8(0x0C)
+#define UCSRA _SFR_IO8(0x0B)
+#define UCSRB _SFR_IO8(0x0A)
+#define UBRRL _SFR_IO8(0x09)
+#define ACSR _SFR_IO8(0x08)
+#define ADMUX _SFR_IO8(0x07)
+#define ADCSRA _SFR_IO8(0x06)
+#define TWDR _SFR_IO8(0x03)
+#define TWAR _SFR_IO8(0x02)
+#define TWSR _SFR_IO8(0x01)
+#define TWBR _SFR_IO8(0x00)
+
+/*------------------------------------------------------------------------------
+ *  							Register Bits
+ *----------------------------------------------------------------------------*/
+
+#define INT1 7
+#define INT0 6
+#define INT2 5
+#define IVSEL 1
+#define IVCE 0
+#define INTF1 7
+#define INTF0 6
+#define INTF2 5
+#define OCIE2 7
+#define TOIE2 6
+#define TICIE1 5
+#define OCIE1A 4
+#define OCIE1B 3
+#define TOIE1 2
+#define OCIE0 1
+#define TOIE0 0
+#define OCF2 7
+#define TOV2 6
+#define ICF1 5
+#define OCF1A 4
+#define OCF1B 3
+#define TOV1 2
+#define OCF0 1
+#define TOV0 0
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+#define SE 7
+#define SM2 6
+#define SM1 5
+#define SM0 4
+#define ISC11 3
+#define ISC10 2
+#define ISC01 1
+#define ISC00 0
+#define JTD 7
+#define ISC2 6
+#define JTRF 4
+#define WDRF 3
+#define BORF 2
+#define EXTRF 1
+#define PORF 0
+#define FOC0 7
+#define WGM00 6
+#define COM01 5
+#define COM00 4
+#define WGM01 3
+#define CS02 2
+#define CS01 1
+#define CS00 0
+#define ADTS2 7
+#define ADTS1 6
+#define ADTS0 5
+#define ACME 3
+#define PUD 2
+#define PSR2 1
+#define PSR10 0
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define FOC1A 3
+#define FOC1B 2
+#define WGM11 1
+#define WGM10 0
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+#define FOC2 7
+#define WGM20 6
+#define COM21 5
+#define COM20 4
+#define WGM21 3
+#define CS22 2
+#define CS21 1
+#define CS20 0
+#define AS2 3
+#define TCN2UB 2
+#define OCR2UB 1
+#define TCR2UB 0
+#define WDTOE 4
+#define WDE 3
+#define WDP2 2
+#define WDP1 1
+#define WDP0 0
+#define URSEL 7
+#define UMSEL 6
+#define UPM1 5
+#define UPM0 4
+#define USBS 3
+#define UCSZ1 2
+#define UCSZ0 1
+#define UCPOL 0
+#define EERIE 3
+#define EEMWE 2
+#define EEWE 1
+#define EERE 0
+#define RXC 7
+#define TXC 6
+#define UDRE 5
+#define FE 4
+#define DOR 3
+#define PE 2
+#define U2X 1
+#define MPCM 0
+#define RXCIE 7
+#define TXCIE 6
+#define UDRIE 5
+#define RXEN 4
+#define TXEN 3
+#define UCSZ2 2
+#define RXB8 1
+#define TXB8 0
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define TWA0 1
+#define TWPS1 1
+#define TWPS0 0
+#define RAMEND                            0x85F
+#define E2END                             0x3FF
+
+#define bit_is_set(SFR, BIT)              ((SFR) & _BV(BIT))
+#define bit_is_clear(SFR, BIT)            (!((SFR) & _BV(BIT)))
+#define loop_until_bit_is_set(SFR, BIT)   do { } while(bit_is_clear(SFR, BIT))
+#define loop_until_bit_is_clear(SFR, BIT) do { } while(bit_is_set(SFR, BIT))
+
+#endif /* SIM_AVR_IO_H_ */
@@ -0,0 +1,19 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : pgmspace.h
+ *  Description : Program memory macros of the host build, the flash tables are
+ *                ordinary constants read directly
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef SIM_AVR_PGMSPACE_H_
+#define SIM_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+
+#define PROGMEM
+#define PSTR(s)                           (s)
+#define pgm_read_byte(a)                  (*(const uint8_t *)(a))
+#define pgm_read_word(a)                  (*(const uint16_t *)(a))
+
+#endif /* SIM_AVR_PGMSPACE_H_ */
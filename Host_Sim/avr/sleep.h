@@ -0,0 +1,28 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : sleep.h
+ *  Description : Sleep macros of the host build, the SLEEP instruction lets the
+ *                virtual time pass until an interrupt wakes the CPU up
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef SIM_AVR_SLEEP_H_
+#define SIM_AVR_SLEEP_H_
+
+#include <avr/io.h>
+
+void SIM_sleep(void);
+
+#define SLEEP_MODE_IDLE                   0
+#define SLEEP_MODE_ADC                    (1 << SM0)
+#define SLEEP_MODE_PWR_DOWN               (1 << SM1)
+#define SLEEP_MODE_PWR_SAVE               ((1 << SM1) | (1 << SM0))
+#define SLEEP_MODE_STANDBY                ((1 << SM2) | (1 << SM1))
+#define SLEEP_MODE_EXT_STANDBY            ((1 << SM2) | (1 << SM1) | (1 << SM0))
+
+#define set_sleep_mode(MODE)              (MCUCR = (MCUCR & (uint8_t)~((1 << SM2) | (1 << SM1) | (1 << SM0))) | (MODE))
+#define sleep_enable()                    (MCUCR |= (1 << SE))
+#define sleep_disable()                   (MCUCR &= (uint8_t)~(1 << SE))
+#define sleep_cpu()                       SIM_sleep()
+
+#endif /* SIM_AVR_SLEEP_H_ */
@@ -0,0 +1,20 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : bind_keypad_tick.h
+ *  Description : Included before every source of isr_cost_call, binds the system
+ *                tick to the out of line KEYPAD_tick instead of the inline event
+ *                of timer.h, to compare the two vectors
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef BIND_KEYPAD_TICK_H_
+#define BIND_KEYPAD_TICK_H_
+
+#include "timer.h"
+
+#undef TIMER_ISR_HANDLERS_HEADER
+#undef TIMER1_COMPA_HANDLER
+#define TIMER_ISR_HANDLERS_HEADER         "keypad.h"
+#define TIMER1_COMPA_HANDLER()            KEYPAD_tick()
+
+#endif /* BIND_KEYPAD_TICK_H_ */
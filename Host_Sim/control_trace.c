@@ -0,0 +1,82 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : control_trace.c
+ *  Description : Runs the Control motor driver on the register mock and records
+ *                its pins in control_trace.vcd
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "sim.h"
+#include "motor.h"
+#include "pwm.h"
+#include "gpio.h"
+#include <stdio.h>
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/* IN1/IN2 states seen by the model, as IN2:IN1 */
+static uint8 g_lastState = 0;
+static uint32 g_transitions = 0;
+static uint32 g_brakeStates = 0;
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * The PWM timer is not simulated, the duty cycle is only printed
+ */
+void PWM_start(uint8 duty_cycle)
+{
+	printf("  PWM duty %u\n", duty_cycle);
+}
+
+/*
+ * Description:
+ * The H-bridge inputs, counts every state IN1/IN2 go through
+ */
+static void motorModel(void)
+{
+	uint8 state = (SIM_getPin(PORTD_ID, PIN6_ID) == LOGIC_HIGH) | ((SIM_getPin(PORTD_ID, PIN7_ID) == LOGIC_HIGH) << 1);
+
+	if(state != g_lastState)
+	{
+		g_transitions++;
+		if(state == 3)
+		{
+			g_brakeStates++;
+		}
+		g_lastState = state;
+	}
+}
+
+static void rotate(DcMotor_State a_state, const char *a_name)
+{
+	uint32 before = g_transitions;
+
+	printf("DcMotor_Rotate(%s)\n", a_name);
+	DcMotor_Rotate(a_state, 255);
+	printf("  IN1/IN2 changes %lu\n", (unsigned long)(g_transitions - before));
+	SIM_delayCycles(F_CPU / 100);
+}
+
+int main(void)
+{
+	SIM_init("control_trace.vcd");
+	SIM_setInputModel(motorModel);
+
+	DcMotor_Init();
+	rotate(CW, "CW");
+	rotate(ACW, "ACW");
+	rotate(STOP, "STOP");
+	rotate(ACW, "ACW");
+	rotate(CW, "CW");
+
+	printf("IN1 and IN2 both high %lu times\n", (unsigned long)g_brakeStates);
+
+	SIM_close();
+	return 0;
+}
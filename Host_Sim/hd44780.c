@@ -0,0 +1,262 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : hd44780.c
+ *  Description : Source file for the model of the HD44780 LCD of the HMI
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "hd44780.h"
+#include "sim.h"
+#include "lcd.h" /* For the pins of the LCD */
+#include "gpio.h"
+#include "common_macros.h" /* For GET_BIT */
+#include <string.h>
+
+#define HD44780_US_TO_CYCLES(US)          ((uint64)(US) * (F_CPU / 1000000UL))
+
+/* Display memory, the second line starts at 0x40 */
+#define HD44780_DDRAM_SIZE                0x80
+#define HD44780_LINE_ADDRESS(ROW)         ((ROW) * 0x40)
+
+/* Function set instruction, DL (bit 4) selects the 8 bits interface */
+#define HD44780_FUNCTION_SET_MASK         0xE0
+#define HD44780_FUNCTION_SET              0x20
+#define HD44780_DL_BIT                    4
+
+/*
+ * Data lines wired to the MCU as in lcd.h, D(HD44780_BUS_FIRST + i) is on the pin i
+ * of the tables. The lines not wired read 0
+ */
+#if (LCD_DATA_BITS_MODE == 4)
+#define HD44780_BUS_LINES                 4
+#define HD44780_BUS_FIRST                 4
+static const uint8 g_busPorts[HD44780_BUS_LINES] = {
+	GPIO_PIN_PORT_ID(LCD_DB4_PIN), GPIO_PIN_PORT_ID(LCD_DB5_PIN),
+	GPIO_PIN_PORT_ID(LCD_DB6_PIN), GPIO_PIN_PORT_ID(LCD_DB7_PIN)};
+static const uint8 g_busPins[HD44780_BUS_LINES] = {
+	GPIO_PIN_NUM(LCD_DB4_PIN), GPIO_PIN_NUM(LCD_DB5_PIN),
+	GPIO_PIN_NUM(LCD_DB6_PIN), GPIO_PIN_NUM(LCD_DB7_PIN)};
+#else
+#define HD44780_BUS_LINES                 8
+#define HD44780_BUS_FIRST                 0
+static const uint8 g_busPorts[HD44780_BUS_LINES] = {
+	GPIO_PORT_ID(LCD_DATA_PORT), GPIO_PORT_ID(LCD_DATA_PORT), GPIO_PORT_ID(LCD_DATA_PORT), GPIO_PORT_ID(LCD_DATA_PORT),
+	GPIO_PORT_ID(LCD_DATA_PORT), GPIO_PORT_ID(LCD_DATA_PORT), GPIO_PORT_ID(LCD_DATA_PORT), GPIO_PORT_ID(LCD_DATA_PORT)};
+static const uint8 g_busPins[HD44780_BUS_LINES] = {0, 1, 2, 3, 4, 5, 6, 7};
+#endif
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+static uint8 g_ddram[HD44780_DDRAM_SIZE];
+static uint8 g_address = 0;
+
+/* Time the last instruction finishes, the busy flag is set until then */
+static uint64 g_busyUntil = 0;
+
+static uint8 g_lastE = LOGIC_LOW;
+/* The LCD drives the data bus */
+static boolean g_driving = FALSE;
+static uint16 g_violations = 0;
+
+/*
+ * Interface of the controller, 8 bits after power on. In 4 bits mode a transfer is
+ * two halves, the upper first, g_lowHalf is set between them
+ */
+static boolean g_fourBits = FALSE;
+static boolean g_lowHalf = FALSE;
+static uint8 g_upperHalf = 0;
+
+static void (*g_writeHook)(uint8 a_rs, uint8 a_value) = NULL_PTR;
+
+/*------------------------------------------------------------------------------
+ *  							Private Functions
+ *----------------------------------------------------------------------------*/
+
+static uint8 HD44780_readPin(uint8 a_port, uint8 a_pin)
+{
+	return (SIM_getPin(a_port, a_pin) == LOGIC_HIGH) ? LOGIC_HIGH : LOGIC_LOW;
+}
+
+/*
+ * Description:
+ * Run an instruction or store a character, the LCD is busy for its execution time
+ */
+static void HD44780_execute(uint8 a_rs, uint8 a_value)
+{
+	uint64 now = SIM_getCycles();
+	uint32 time_us = HD44780_COMMAND_US;
+
+	if(a_rs)
+	{
+		g_ddram[g_address] = a_value;
+		g_address = (g_address + 1) & (HD44780_DDRAM_SIZE - 1);
+		time_us = HD44780_DATA_US;
+	}
+	else if(a_value & 0x80)
+	{
+		/* Set the display memory address */
+		g_address = a_value & (HD44780_DDRAM_SIZE - 1);
+	}
+	else if((a_value & HD44780_FUNCTION_SET_MASK) == HD44780_FUNCTION_SET)
+	{
+		g_fourBits = !GET_BIT(a_value, HD44780_DL_BIT);
+		g_lowHalf = FALSE;
+	}
+	else if(a_value == LCD_CLEAR_COMMAND)
+	{
+		memset(g_ddram, ' ', sizeof(g_ddram));
+		g_address = 0;
+		time_us = HD44780_CLEAR_US;
+	}
+	else if((a_value & 0xFE) == LCD_GO_TO_HOME)
+	{
+		g_address = 0;
+		time_us = HD44780_CLEAR_US;
+	}
+
+	g_busyUntil = now + HD44780_US_TO_CYCLES(time_us);
+
+	if(g_writeHook != NULL_PTR)
+	{
+		g_writeHook(a_rs, a_value);
+	}
+}
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Clear the display memory, the module is powered on at the current time
+ */
+void HD44780_init(void)
+{
+	memset(g_ddram, ' ', sizeof(g_ddram));
+	g_address = 0;
+	g_busyUntil = 0;
+	g_lastE = LOGIC_LOW;
+	g_driving = FALSE;
+	g_violations = 0;
+	g_fourBits = FALSE;
+	g_lowHalf = FALSE;
+}
+
+/*
+ * Description:
+ * The LCD on the pins of lcd.h: it takes the data bus when E falls with R/W low and
+ * drives the busy flag and the address while E is high with R/W high. With 4 data
+ * lines it moves from the 8 bits to the 4 bits interface by the function set.
+ * Call it from the input model of the board
+ */
+void HD44780_model(void)
+{
+	uint8 e, rs, rw = LOGIC_LOW, line, value = 0;
+	uint8 status;
+	uint64 now;
+
+	e = HD44780_readPin(GPIO_PIN_PORT_ID(LCD_E_PIN), GPIO_PIN_NUM(LCD_E_PIN));
+	rs = HD44780_readPin(GPIO_PIN_PORT_ID(LCD_RS_PIN), GPIO_PIN_NUM(LCD_RS_PIN));
+#ifdef LCD_RW_PIN
+	rw = HD44780_readPin(GPIO_PIN_PORT_ID(LCD_RW_PIN), GPIO_PIN_NUM(LCD_RW_PIN));
+#endif
+
+	if((e == LOGIC_HIGH) && (rw == LOGIC_HIGH) && (rs == LOGIC_LOW))
+	{
+		if(!g_driving)
+		{
+			status = (SIM_getCycles() < g_busyUntil) ? (0x80 | g_address) : g_address;
+			if(g_fourBits && g_lowHalf)
+			{
+				status <<= 4;
+			}
+			for(line = 0; line < HD44780_BUS_LINES; line++)
+			{
+				SIM_setInput(g_busPorts[line], g_busPins[line], (status >> (HD44780_BUS_FIRST + line)) & 1);
+			}
+			g_driving = TRUE;
+		}
+	}
+	else if(g_driving)
+	{
+		for(line = 0; line < HD44780_BUS_LINES; line++)
+		{
+			SIM_releaseInput(g_busPorts[line], g_busPins[line]);
+		}
+		g_driving = FALSE;
+	}
+
+	if((g_lastE == LOGIC_HIGH) && (e == LOGIC_LOW))
+	{
+		if(rw == LOGIC_LOW)
+		{
+			/* A write while busy or before the power on time is lost */
+			now = SIM_getCycles();
+			if((now < HD44780_US_TO_CYCLES(HD44780_POWER_ON_US)) || (now < g_busyUntil))
+			{
+				g_violations++;
+			}
+
+			for(line = 0; line < HD44780_BUS_LINES; line++)
+			{
+				value |= HD44780_readPin(g_busPorts[line], g_busPins[line]) << (HD44780_BUS_FIRST + line);
+			}
+
+			if(!g_fourBits)
+			{
+				HD44780_execute(rs, value);
+			}
+			else if(!g_lowHalf)
+			{
+				g_upperHalf = value;
+				g_lowHalf = TRUE;
+			}
+			else
+			{
+				g_lowHalf = FALSE;
+				HD44780_execute(rs, g_upperHalf | (value >> 4));
+			}
+		}
+		else if(g_fourBits)
+		{
+			/* The reads are in two halves too */
+			g_lowHalf = !g_lowHalf;
+		}
+	}
+	g_lastE = e;
+}
+
+/*
+ * Description:
+ * Set the function called for every instruction (a_rs = 0) or character (a_rs = 1)
+ * the LCD takes
+ */
+void HD44780_setWriteHook(void (*a_hook)(uint8 a_rs, uint8 a_value))
+{
+	g_writeHook = a_hook;
+}
+
+/*
+ * Description:
+ * Return the number of writes made while the LCD was busy or before its power
+ * on time, the LCD ignores them or shows garbage
+ */
+uint16 HD44780_getViolations(void)
+{
+	return g_violations;
+}
+
+/*
+ * Description:
+ * Copy the HD44780_COLS characters shown on the line a_row to a_text, with a '\0' after them
+ */
+void HD44780_getLine(uint8 a_row, char *a_text)
+{
+	/* Reading a pin commits the last write of the MCU, it may be the fall of E */
+	(void)SIM_getPin(GPIO_PIN_PORT_ID(LCD_E_PIN), GPIO_PIN_NUM(LCD_E_PIN));
+
+	memcpy(a_text, &g_ddram[HD44780_LINE_ADDRESS(a_row)], HD44780_COLS);
+	a_text[HD44780_COLS] = '\0';
+}
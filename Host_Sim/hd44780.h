@@ -0,0 +1,69 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : hd44780.h
+ *  Description : Header file for the model of the HD44780 LCD of the HMI
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef HD44780_H_
+#define HD44780_H_
+
+#include "std_types.h"
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Execution times of the controller at its typical 270kHz clock in microseconds,
+ * and the time after power on before it takes instructions
+ */
+#define HD44780_COMMAND_US                37
+#define HD44780_DATA_US                   (37 + 4)
+#define HD44780_CLEAR_US                  1520
+#define HD44780_POWER_ON_US               15000
+
+/* Characters shown on a line of the 2x16 module */
+#define HD44780_COLS                      16
+#define HD44780_ROWS                      2
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Clear the display memory, the module is powered on at the current time
+ */
+void HD44780_init(void);
+
+/*
+ * Description:
+ * The LCD on the pins of lcd.h: it takes the data bus when E falls with R/W low and
+ * drives the busy flag and the address while E is high with R/W high. With 4 data
+ * lines it moves from the 8 bits to the 4 bits interface by the function set.
+ * Call it from the input model of the board
+ */
+void HD44780_model(void);
+
+/*
+ * Description:
+ * Set the function called for every instruction (a_rs = 0) or character (a_rs = 1)
+ * the LCD takes
+ */
+void HD44780_setWriteHook(void (*a_hook)(uint8 a_rs, uint8 a_value));
+
+/*
+ * Description:
+ * Return the number of writes made while the LCD was busy or before its power
+ * on time, the LCD ignores them or shows garbage
+ */
+uint16 HD44780_getViolations(void);
+
+/*
+ * Description:
+ * Copy the HD44780_COLS characters shown on the line a_row to a_text, with a '\0' after them
+ */
+void HD44780_getLine(uint8 a_row, char *a_text);
+
+#endif /* HD44780_H_ */
@@ -0,0 +1,441 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : hmi_bench.c
+ *  Description : Runs the whole HMI application on the register mock, types
+ *                scripted passwords on the keypad matrix and measures the time
+ *                from a key press to its '*' on the LCD and from ENTER to the
+ *                last byte of the password received by the Control ECU
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "sim.h"
+#include "matrix.h"
+#include "hd44780.h"
+
+/*
+ * The application is built as it is, only its main is renamed so the bench can
+ * start it after setting up the board around the MCU
+ */
+#define main HMI_main
+#include "hmi.c"
+#undef main
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+#define MS_TO_CYCLES(MS)                  ((uint64)(MS) * (F_CPU / 1000UL))
+#define CYCLES_TO_MS(CYCLES)              ((double)(CYCLES) * 1000.0 / F_CPU)
+
+/* Password changes typed after the first password is set, each one is 19 keys */
+#define BENCH_ROUNDS                      20
+#define BENCH_PASSWORD                    "12345"
+
+/* The first key is pressed after the project name is gone */
+#define BENCH_FIRST_KEY_MS                (SPLASH_TIME + 500)
+
+/* Random hold time of a key and time from a release to the next press */
+#define BENCH_HOLD_MIN_MS                 40
+#define BENCH_HOLD_MAX_MS                 160
+#define BENCH_GAP_MIN_MS                  150
+#define BENCH_GAP_MAX_MS                  450
+
+/* Time the Control ECU takes to check a password, then its frames at 9600 8N1 */
+#define BENCH_CONTROL_DELAY_MS            1
+#define BENCH_FRAME_CYCLES                ((10ULL * F_CPU) / 9600UL)
+
+/* Bytes of a password packet: READY then the digits */
+#define BENCH_PACKET_LENGTH               (1 + PASS_LENGTH)
+
+#define BENCH_MAX_SAMPLES                 512
+#define BENCH_HISTOGRAM_BINS              10
+#define BENCH_HISTOGRAM_WIDTH             50
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef struct
+{
+	const char *name;
+	uint16 count;
+	uint64 cycles[BENCH_MAX_SAMPLES];
+} BENCH_SamplesType;
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/* Keys to type: digits, 'E' for ENTER, '-' and '+' for the menu */
+static char g_script[(BENCH_ROUNDS + 1) * 3 * (PASS_LENGTH + 1) + BENCH_ROUNDS + 1];
+static uint16 g_scriptPos = 0;
+
+static uint32 g_seed = 1;
+
+/* Time the system clock started, Timer1 counts the cycles from then */
+static uint64 g_clockStart = 0;
+
+/* Press of a digit that did not show its '*' yet */
+static boolean g_echoPending = FALSE;
+static uint64 g_pressCycles = 0;
+static uint16 g_lostKeys = 0;
+
+/* ENTER pressed and the password packet not received yet */
+static boolean g_enterPending = FALSE;
+static uint64 g_enterCycles = 0;
+
+/* The Control ECU side: bytes of the packet received and what it answers next */
+static uint8 g_packetBytes = 0;
+static boolean g_checkNext = FALSE;
+static boolean g_confirmNext = FALSE;
+
+static BENCH_SamplesType g_echo = {"Key press to '*' on the LCD", 0, {0}};
+static BENCH_SamplesType g_send = {"ENTER to password received", 0, {0}};
+
+/*------------------------------------------------------------------------------
+ *  				Replacements of the Timer and RTC Drivers
+ *----------------------------------------------------------------------------*/
+
+void INT0_vect(void);
+void USART_RXC_vect(void);
+
+/*
+ * Description:
+ * The system tick of timer.c, SIM_VECTOR_TICK runs TIMER1_COMPA_HANDLER like its vector
+ */
+static void tickVector(void)
+{
+	TIMER1_COMPA_HANDLER();
+}
+
+void Timer_startSystemClock(void)
+{
+	g_clockStart = SIM_getCycles();
+	SIM_setTick(MS_TO_CYCLES(TIMER_SYSCLK_TICK_MS));
+}
+
+/*
+ * Description:
+ * Timer1 stops in power-save and RTC_sleep adds the time slept, so the
+ * system clock follows the virtual time
+ */
+uint32 Timer_getMillis(void)
+{
+	return (uint32)((SIM_getCycles() - g_clockStart) / (F_CPU / 1000UL));
+}
+
+uint32 Timer_getMicros(void)
+{
+	return (uint32)((SIM_getCycles() - g_clockStart) / (F_CPU / 1000000UL));
+}
+
+void RTC_init(void)
+{
+}
+
+/*
+ * Description:
+ * Power-save like rtc.c, without the wake up of every second
+ */
+void RTC_sleep(void)
+{
+	set_sleep_mode(SLEEP_MODE_PWR_SAVE);
+	sleep_enable();
+	sei();
+	sleep_cpu();
+	sleep_disable();
+}
+
+/*------------------------------------------------------------------------------
+ *  							The Board
+ *----------------------------------------------------------------------------*/
+
+static uint32 randomMs(uint32 a_min, uint32 a_max)
+{
+	g_seed = (g_seed * 1103515245UL) + 12345UL;
+	return a_min + (((g_seed >> 16) & 0x7FFF) % (a_max - a_min + 1));
+}
+
+static void addSample(BENCH_SamplesType *a_samples, uint64 a_cycles)
+{
+	if(a_samples->count < BENCH_MAX_SAMPLES)
+	{
+		a_samples->cycles[a_samples->count++] = a_cycles;
+	}
+}
+
+/*
+ * Description:
+ * The keypad and the LCD around the MCU
+ */
+static void boardModel(void)
+{
+	MATRIX_model();
+	HD44780_model();
+}
+
+/*
+ * Description:
+ * Take the time of every '*' the LCD receives
+ */
+static void lcdWrite(uint8 a_rs, uint8 a_value)
+{
+	if(a_rs && (a_value == '*') && g_echoPending)
+	{
+		g_echoPending = FALSE;
+		addSample(&g_echo, SIM_getCycles() - g_pressCycles);
+	}
+}
+
+static void controlSend(uint8 a_byte)
+{
+	SIM_receiveByte(a_byte);
+}
+
+/*
+ * Description:
+ * The Control ECU receiving the HMI bytes: a command byte before a check, then
+ * packets of READY and the digits. It answers the checks and the confirmations
+ */
+static void controlReceive(uint8 a_byte, uint64 a_doneCycles)
+{
+	uint64 reply;
+
+	if(g_packetBytes == 0)
+	{
+		if(a_byte == CHANGEPASS || a_byte == OPENDOOR)
+		{
+			g_checkNext = TRUE;
+			return;
+		}
+		if(a_byte != READY)
+		{
+			return;
+		}
+	}
+
+	g_packetBytes++;
+	if(g_packetBytes < BENCH_PACKET_LENGTH)
+	{
+		return;
+	}
+	g_packetBytes = 0;
+
+	if(g_enterPending)
+	{
+		g_enterPending = FALSE;
+		addSample(&g_send, a_doneCycles - g_enterCycles);
+	}
+
+	/*
+	 * A checked password is followed by a new one, a new one by its confirmation
+	 */
+	if(g_checkNext || g_confirmNext)
+	{
+		g_checkNext = FALSE;
+		g_confirmNext = FALSE;
+		reply = a_doneCycles + MS_TO_CYCLES(BENCH_CONTROL_DELAY_MS);
+		SIM_at(reply, controlSend, READY);
+		SIM_at(reply + BENCH_FRAME_CYCLES, controlSend, NO_REPEAT);
+	}
+	else
+	{
+		g_confirmNext = TRUE;
+	}
+}
+
+/*
+ * Description:
+ * Row and column of the key a_key in KEYPAD_KEYMAP
+ */
+static void findKey(uint8 a_key, sint8 *a_row, sint8 *a_col)
+{
+	static const uint8 keymap[KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS] = KEYPAD_KEYMAP;
+	uint8 i;
+
+	for(i = 0; i < KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS; i++)
+	{
+		if(keymap[i] == a_key)
+		{
+			*a_row = i / KEYPAD_NUM_COLS;
+			*a_col = i % KEYPAD_NUM_COLS;
+			return;
+		}
+	}
+
+	fprintf(stderr, "hmi_bench: key %u is not on the keypad\n", a_key);
+	exit(1);
+}
+
+static void keyUp(uint8 a_arg);
+static void finish(uint8 a_arg);
+
+/*
+ * Description:
+ * Press the next key of the script and take its time
+ */
+static void keyDown(uint8 a_arg)
+{
+	char c = g_script[g_scriptPos];
+	uint8 key;
+	sint8 row, col;
+
+	(void)a_arg;
+	if((c >= '0') && (c <= '9'))
+	{
+		key = c - '0';
+
+		/* The '*' of the digit before never came */
+		if(g_echoPending)
+		{
+			g_lostKeys++;
+		}
+		g_echoPending = TRUE;
+		g_pressCycles = SIM_getCycles();
+	}
+	else if(c == 'E')
+	{
+		key = KEYPAD_ENTER_KEY;
+		g_enterPending = TRUE;
+		g_enterCycles = SIM_getCycles();
+	}
+	else
+	{
+		key = c;
+	}
+
+	findKey(key, &row, &col);
+	MATRIX_pressKey(row, col);
+	SIM_at(SIM_getCycles() + MS_TO_CYCLES(randomMs(BENCH_HOLD_MIN_MS, BENCH_HOLD_MAX_MS)), keyUp, 0);
+}
+
+static void keyUp(uint8 a_arg)
+{
+	(void)a_arg;
+	MATRIX_pressKey(-1, -1);
+
+	g_scriptPos++;
+	if(g_script[g_scriptPos] != '\0')
+	{
+		SIM_at(SIM_getCycles() + MS_TO_CYCLES(randomMs(BENCH_GAP_MIN_MS, BENCH_GAP_MAX_MS)), keyDown, 0);
+	}
+	else
+	{
+		SIM_at(SIM_getCycles() + MS_TO_CYCLES(1000), finish, 0);
+	}
+}
+
+/*------------------------------------------------------------------------------
+ *  							The Report
+ *----------------------------------------------------------------------------*/
+
+static int compareCycles(const void *a_first, const void *a_second)
+{
+	uint64 first = *(const uint64 *)a_first;
+	uint64 second = *(const uint64 *)a_second;
+
+	return (first > second) - (first < second);
+}
+
+/*
+ * Description:
+ * Print the minimum, the percentiles and the maximum of the samples in milliseconds,
+ * then their histogram
+ */
+static void printSamples(BENCH_SamplesType *a_samples)
+{
+	uint16 bins[BENCH_HISTOGRAM_BINS] = {0};
+	uint16 i, most = 0;
+	uint64 min, max, width;
+	uint8 bin, numBins;
+
+	printf("%s, %u samples\n", a_samples->name, a_samples->count);
+	if(a_samples->count == 0)
+	{
+		return;
+	}
+
+	qsort(a_samples->cycles, a_samples->count, sizeof(uint64), compareCycles);
+	min = a_samples->cycles[0];
+	max = a_samples->cycles[a_samples->count - 1];
+	printf("  min %.2f  median %.2f  p90 %.2f  p99 %.2f  max %.2f ms\n", CYCLES_TO_MS(min),
+	       CYCLES_TO_MS(a_samples->cycles[a_samples->count / 2]),
+	       CYCLES_TO_MS(a_samples->cycles[(a_samples->count * 9) / 10]),
+	       CYCLES_TO_MS(a_samples->cycles[(a_samples->count * 99) / 100]), CYCLES_TO_MS(max));
+
+	/* Samples that are all the same are one bin */
+	numBins = (max == min) ? 1 : BENCH_HISTOGRAM_BINS;
+	width = ((max - min) / numBins) + 1;
+	for(i = 0; i < a_samples->count; i++)
+	{
+		bin = (a_samples->cycles[i] - min) / width;
+		bins[bin]++;
+		if(bins[bin] > most)
+		{
+			most = bins[bin];
+		}
+	}
+	for(bin = 0; bin < numBins; bin++)
+	{
+		printf("  %7.2f - %7.2f ms %4u ", CYCLES_TO_MS(min + (bin * width)), CYCLES_TO_MS(min + ((bin + 1) * width)), bins[bin]);
+		for(i = 0; i < (bins[bin] * BENCH_HISTOGRAM_WIDTH + most - 1) / most; i++)
+		{
+			putchar('#');
+		}
+		putchar('\n');
+	}
+}
+
+static void finish(uint8 a_arg)
+{
+	(void)a_arg;
+	if(g_echoPending)
+	{
+		g_lostKeys++;
+	}
+
+	printf("Typed %u keys in %.1f s, %u digits without '*', %u bytes cut by a sleep, %u LCD busy violations\n",
+	       (unsigned)strlen(g_script), CYCLES_TO_MS(SIM_getCycles()) / 1000.0, g_lostKeys, SIM_getCutBytes(),
+	       HD44780_getViolations());
+	printSamples(&g_echo);
+	printSamples(&g_send);
+
+	SIM_close();
+	exit(0);
+}
+
+int main(void)
+{
+	uint8 round, entry;
+
+	/*
+	 * Set the first password, then change it BENCH_ROUNDS times: the old one,
+	 * the new one and its confirmation
+	 */
+	strcpy(g_script, BENCH_PASSWORD "E" BENCH_PASSWORD "E");
+	for(round = 0; round < BENCH_ROUNDS; round++)
+	{
+		strcat(g_script, "-");
+		for(entry = 0; entry < 3; entry++)
+		{
+			strcat(g_script, BENCH_PASSWORD "E");
+		}
+	}
+
+	SIM_init(NULL_PTR);
+	HD44780_init();
+	HD44780_setWriteHook(lcdWrite);
+	SIM_setInputModel(boardModel);
+	SIM_setVector(SIM_VECTOR_INT0, INT0_vect);
+	SIM_setVector(SIM_VECTOR_TICK, tickVector);
+	SIM_setVector(SIM_VECTOR_USART_RXC, USART_RXC_vect);
+	SIM_setTxHook(controlReceive);
+	SIM_at(MS_TO_CYCLES(BENCH_FIRST_KEY_MS), keyDown, 0);
+
+	/* Runs until finish ends the bench */
+	return HMI_main();
+}
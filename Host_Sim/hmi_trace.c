@@ -0,0 +1,282 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : hmi_trace.c
+ *  Description : Runs the HMI LCD and keypad drivers on the register mock and
+ *                records their pins in hmi_trace.vcd
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "sim.h"
+#include "matrix.h"
+#include "hd44780.h"
+#include "lcd.h"
+#include "keypad.h"
+#include "exti.h"
+#include "gpio.h"
+#include "profiler.h"
+#include <avr/interrupt.h>
+#include <stdio.h>
+
+/* Cycles the scheduler loop takes between two runs of a task */
+#define SCHED_LOOP_CYCLES                 80
+
+/* Cycles to microseconds */
+#define CYCLES_TO_US(CYCLES)              ((double)(CYCLES) * 1000000.0 / F_CPU)
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/* The profiler statistics the ISRs of the drivers update */
+volatile PROFILER_StatsType g_profilerStats;
+
+/* Time the any key call back ran */
+static uint64 g_anyKeyCycles = 0;
+
+/* Longest KEYPAD_tick and number of ticks that scanned the keypad */
+static uint64 g_tickMaxCycles = 0;
+static uint16 g_tickScans = 0;
+
+/* Key events read after every tick, as key number and P(ress) R(elease) D(repeat) L(ong press) */
+static char g_events[128];
+static uint8 g_eventsLength = 0;
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+void INT0_vect(void);
+
+/* Instructions and characters the LCD took */
+static uint16 g_lcdWrites = 0;
+
+static void lcdWrite(uint8 a_rs, uint8 a_value)
+{
+	g_lcdWrites++;
+}
+
+/*
+ * Description:
+ * The keypad and the LCD around the MCU
+ */
+static void boardModel(void)
+{
+	MATRIX_model();
+	HD44780_model();
+}
+
+/*
+ * Description:
+ * The system clock of timer.c, the keypad measures the wake up latency with it
+ */
+uint32 Timer_getMicros(void)
+{
+	return SIM_getCycles() / (F_CPU / 1000000UL);
+}
+
+static void anyKeyCallBack(void)
+{
+	g_anyKeyCycles = SIM_getCycles();
+}
+
+/*
+ * Description:
+ * Let a_ticks system ticks pass, calling KEYPAD_tick like the keypad task of hmi.c does
+ */
+static void runTicks(uint16 a_ticks)
+{
+	uint64 start;
+	KEYPAD_EventType event;
+
+	while(a_ticks--)
+	{
+		SIM_delayCycles((F_CPU / 1000) * TIMER_SYSCLK_TICK_MS);
+		start = SIM_getCycles();
+		KEYPAD_tick();
+		start = SIM_getCycles() - start;
+		if(start > 0)
+		{
+			g_tickScans++;
+		}
+		if(start > g_tickMaxCycles)
+		{
+			g_tickMaxCycles = start;
+		}
+		while(KEYPAD_getEvent(&event) && (g_eventsLength < sizeof(g_events) - 8))
+		{
+			g_eventsLength += sprintf(&g_events[g_eventsLength], " %u%c", event.key, "PRDL"[event.kind]);
+		}
+	}
+}
+
+int main(void)
+{
+	uint64 start;
+	uint16 matrix;
+	uint8 key;
+	uint64 redraw, longest;
+	uint16 calls;
+	boolean busy;
+	char line[HD44780_COLS + 1];
+
+	SIM_init("hmi_trace.vcd");
+	HD44780_init();
+	HD44780_setWriteHook(lcdWrite);
+	SIM_setInputModel(boardModel);
+	SIM_setVector(SIM_VECTOR_INT0, INT0_vect);
+	sei();
+
+	start = SIM_getCycles();
+	LCD_init();
+	printf("LCD_init                  %10.1f us\n", CYCLES_TO_US(SIM_getCycles() - start));
+
+	start = SIM_getCycles();
+	LCD_displayCharacter('*');
+	LCD_flush();
+	printf("LCD_flush 1 character     %10.1f us\n", CYCLES_TO_US(SIM_getCycles() - start));
+
+	/*
+	 * A new screen is the framebuffer cleared then written, only the changes are sent
+	 */
+	start = SIM_getCycles();
+	LCD_clearScreen();
+	LCD_displayString("Enter Pass:");
+	g_lcdWrites = 0;
+	LCD_flush();
+	printf("LCD_flush \"Enter Pass:\"   %10.1f us  writes %u\n", CYCLES_TO_US(SIM_getCycles() - start), g_lcdWrites);
+
+	start = SIM_getCycles();
+	LCD_clearScreen();
+	LCD_displayString("Re-Enter Pass:");
+	g_lcdWrites = 0;
+	LCD_flush();
+	printf("LCD_flush \"Re-Enter Pass:\"%10.1f us  writes %u\n", CYCLES_TO_US(SIM_getCycles() - start), g_lcdWrites);
+
+	start = SIM_getCycles();
+	LCD_clearScreen();
+	LCD_displayString("Re-Enter Pass:");
+	g_lcdWrites = 0;
+	LCD_flush();
+	printf("LCD_flush same screen     %10.1f us  writes %u\n", CYCLES_TO_US(SIM_getCycles() - start), g_lcdWrites);
+
+	/*
+	 * The same redraw in the background, every call of LCD_refresh returns at once and
+	 * the loop of the scheduler (about 10us) runs between the calls
+	 */
+	LCD_clearScreen();
+	LCD_displayString("Door Closing");
+	g_lcdWrites = 0;
+	calls = 0;
+	longest = 0;
+	redraw = SIM_getCycles();
+	do
+	{
+		start = SIM_getCycles();
+		busy = LCD_refresh();
+		if((SIM_getCycles() - start) > longest)
+		{
+			longest = SIM_getCycles() - start;
+		}
+		calls++;
+		SIM_delayCycles(SCHED_LOOP_CYCLES);
+	} while(busy);
+	printf("LCD_refresh \"Door Closing\"%9.1f us  writes %u  calls %u  longest call %.1f us\n",
+	       CYCLES_TO_US(SIM_getCycles() - redraw), g_lcdWrites, calls, CYCLES_TO_US(longest));
+	HD44780_getLine(0, line);
+	printf("LCD line 0                \"%s\"  busy violations %u\n", line, HD44780_getViolations());
+
+	start = SIM_getCycles();
+	key = KEYPAD_readKey();
+	printf("KEYPAD_readKey no key     %10.1f us  key %u\n", CYCLES_TO_US(SIM_getCycles() - start), key);
+
+	MATRIX_pressKey(2, 1);
+	start = SIM_getCycles();
+	key = KEYPAD_readKey();
+	printf("KEYPAD_readKey row 2 col 1%10.1f us  key %u\n", CYCLES_TO_US(SIM_getCycles() - start), key);
+	MATRIX_pressKey(-1, -1);
+
+	/*
+	 * Matrix snapshot: two keys are a multi key, three corners of a rectangle
+	 * also read the fourth one
+	 */
+	MATRIX_pressKeys(KEYPAD_MATRIX_BIT(0, 0) | KEYPAD_MATRIX_BIT(2, 1));
+	start = SIM_getCycles();
+	matrix = KEYPAD_readMatrix();
+	start = SIM_getCycles() - start;
+	printf("KEYPAD_readMatrix 2 keys  %10.1f us  matrix %04X key %u\n", CYCLES_TO_US(start), matrix, KEYPAD_readKey());
+	MATRIX_pressKeys(KEYPAD_MATRIX_BIT(0, 0) | KEYPAD_MATRIX_BIT(0, 1) | KEYPAD_MATRIX_BIT(2, 1));
+	matrix = KEYPAD_readMatrix();
+	printf("KEYPAD_readMatrix 3 keys              matrix %04X key %u ghosted %u\n", matrix, KEYPAD_readKey(), KEYPAD_isGhosted(matrix));
+	MATRIX_pressKey(-1, -1);
+
+	/*
+	 * Any key line: arm it, wait, then press a key and time the interrupt
+	 */
+	KEYPAD_enableAnyKey(anyKeyCallBack);
+	KEYPAD_armAnyKey();
+	SIM_delayCycles(F_CPU / 1000);
+	start = SIM_getCycles();
+	MATRIX_pressKey(3, 3);
+	if(g_anyKeyCycles != 0)
+	{
+		printf("Key press to call back    %10.1f us\n", CYCLES_TO_US(g_anyKeyCycles - start));
+	}
+	else
+	{
+		printf("Key press to call back    no interrupt\n");
+	}
+	key = KEYPAD_readKey();
+	printf("Key after the interrupt   %u\n", key);
+	MATRIX_pressKey(-1, -1);
+	SIM_delayCycles(F_CPU / 1000);
+
+	/*
+	 * Background scanner: run the system tick by hand. Type a key that bounces,
+	 * hold another one past the long press, then type two keys quickly
+	 */
+	KEYPAD_init();
+	runTicks(5);
+	for(key = 0; key < 3; key++)
+	{
+		MATRIX_pressKey(2, 0);
+		SIM_delayCycles(F_CPU / 1000);
+		MATRIX_pressKey(-1, -1);
+		SIM_delayCycles(F_CPU / 1000);
+	}
+	MATRIX_pressKey(2, 0);
+	runTicks(6);
+	MATRIX_pressKey(-1, -1);
+	runTicks(6);
+	MATRIX_pressKey(0, 2);
+	runTicks(120);
+	MATRIX_pressKey(-1, -1);
+	runTicks(6);
+	MATRIX_pressKey(1, 1);
+	runTicks(4);
+	MATRIX_pressKey(-1, -1);
+	runTicks(4);
+	MATRIX_pressKey(3, 1);
+	runTicks(4);
+	MATRIX_pressKey(-1, -1);
+	runTicks(6);
+	printf("KEYPAD_tick longest       %10.1f us  scans %u\n", CYCLES_TO_US(g_tickMaxCycles), g_tickScans);
+	printf("Key events               %s\n", g_events);
+
+	/*
+	 * Wake on key: sense the low level, sleep for a second (the I/O clock and the
+	 * tick are stopped), press a key and run the ticks to its press event
+	 */
+	if(KEYPAD_armWake())
+	{
+		SIM_delayCycles(F_CPU);
+		MATRIX_pressKey(1, 0);
+		KEYPAD_disarmWake();
+		runTicks(6);
+		MATRIX_pressKey(-1, -1);
+		runTicks(4);
+		printf("Wake to first key         %10.1f us  INT0 sense %u\n", (double)KEYPAD_getWakeLatency(), (MCUCR >> ISC00) & 3);
+	}
+
+	SIM_close();
+	return 0;
+}
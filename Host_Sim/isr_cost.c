@@ -0,0 +1,60 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : isr_cost.c
+ *  Description : Counts the cycles of the system tick vector of the HMI timer.c
+ *                with the binding of timer.h, and of a vector that dispatches
+ *                through Timer_setCallBack
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "sim.h"
+#include "timer.h"
+#include "keypad.h"
+#include <avr/io.h>
+#include <stdio.h>
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/* Cycles to the interrupt, long enough for any vector to return before the next one */
+#define ISR_COST_PERIOD                   1000
+
+#define ISR_COST_STR(X)                   ISR_COST_STR_(X)
+#define ISR_COST_STR_(X)                  #X
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+void TIMER0_COMP_vect(void);
+void TIMER1_COMPA_vect(void);
+
+/*
+ * Description:
+ * Serve the vector once through SIM_VECTOR_TICK and print what it cost
+ */
+static void serveOnce(void (*a_vector)(void), const char *a_name)
+{
+	SIM_setVector(SIM_VECTOR_TICK, a_vector);
+	SIM_setTick(ISR_COST_PERIOD);
+	SIM_delayCycles(ISR_COST_PERIOD + (ISR_COST_PERIOD / 2));
+	SIM_setTick(0);
+
+	printf("%-62s %4lu cycles  calls %u\n", a_name, (unsigned long)SIM_getVectorCycles(SIM_VECTOR_TICK),
+	       SIM_getVectorCalls(SIM_VECTOR_TICK));
+}
+
+int main(void)
+{
+	SIM_init(NULL_PTR);
+	SREG = 1 << 7;
+
+	serveOnce(TIMER1_COMPA_vect, "TIMER1_COMPA bound to " ISR_COST_STR(TIMER1_COMPA_HANDLER()));
+
+	Timer_setCallBack(KEYPAD_tick, TIMER_timer0);
+	serveOnce(TIMER0_COMP_vect, "TIMER0_COMP through Timer_setCallBack(KEYPAD_tick)");
+
+	SIM_close();
+	return 0;
+}
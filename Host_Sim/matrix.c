@@ -0,0 +1,100 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : matrix.c
+ *  Description : Source file for the model of the HMI keypad matrix
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "matrix.h"
+#include "sim.h"
+#include "keypad.h" /* For the pins of the matrix */
+#include "gpio.h"
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/* Keys held on the matrix as KEYPAD_MATRIX_BIT bits */
+static uint16 g_pressed = 0;
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * The keypad matrix with pull ups on the columns, and the any key line that
+ * the columns pull low through diodes. A row driven low pulls low every column
+ * it reaches through the held keys, also through other rows, which makes ghosts.
+ * Give it to SIM_setInputModel, or call it from the model of the whole board
+ */
+void MATRIX_model(void)
+{
+	uint8 col, row;
+	uint8 lowRows = 0, lowCols = 0, reachedRows, reachedCols;
+
+	for(row = 0; row < KEYPAD_NUM_ROWS; row++)
+	{
+		if(SIM_getPin(GPIO_PORT_ID(KEYPAD_ROW_PORT), KEYPAD_FIRST_ROW_PIN + row) == LOGIC_LOW)
+		{
+			lowRows |= 1 << row;
+		}
+	}
+
+	do
+	{
+		reachedRows = lowRows;
+		reachedCols = lowCols;
+		for(row = 0; row < KEYPAD_NUM_ROWS; row++)
+		{
+			for(col = 0; col < KEYPAD_NUM_COLS; col++)
+			{
+				if(g_pressed & KEYPAD_MATRIX_BIT(row, col))
+				{
+					if(lowRows & (1 << row))
+					{
+						lowCols |= 1 << col;
+					}
+					if(lowCols & (1 << col))
+					{
+						lowRows |= 1 << row;
+					}
+				}
+			}
+		}
+	}while((reachedRows != lowRows) || (reachedCols != lowCols));
+
+	for(col = 0; col < KEYPAD_NUM_COLS; col++)
+	{
+		SIM_setInput(GPIO_PORT_ID(KEYPAD_COL_PORT), KEYPAD_FIRST_COL_PIN + col, (lowCols & (1 << col)) ? LOGIC_LOW : LOGIC_HIGH);
+	}
+
+	if(lowCols)
+	{
+		SIM_setInput(PORTD_ID, PIN2_ID, LOGIC_LOW);
+	}
+	else
+	{
+		SIM_releaseInput(PORTD_ID, PIN2_ID);
+	}
+}
+
+/*
+ * Description:
+ * Hold the keys a_keys, KEYPAD_MATRIX_BIT bits, and release the others
+ */
+void MATRIX_pressKeys(uint16 a_keys)
+{
+	g_pressed = a_keys;
+	SIM_delayCycles(0); /* Let the model see the keys */
+	SIM_releaseInput(PORTD_ID, PIN7_ID); /* Any input change runs the model */
+}
+
+/*
+ * Description:
+ * Hold only the key at a_row, a_col, or release all the keys if a_row is negative
+ */
+void MATRIX_pressKey(sint8 a_row, sint8 a_col)
+{
+	MATRIX_pressKeys((a_row < 0) ? 0 : KEYPAD_MATRIX_BIT(a_row, a_col));
+}
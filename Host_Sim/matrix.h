@@ -0,0 +1,38 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : matrix.h
+ *  Description : Header file for the model of the HMI keypad matrix
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef MATRIX_H_
+#define MATRIX_H_
+
+#include "std_types.h"
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * The keypad matrix with pull ups on the columns, and the any key line that
+ * the columns pull low through diodes. A row driven low pulls low every column
+ * it reaches through the held keys, also through other rows, which makes ghosts.
+ * Give it to SIM_setInputModel, or call it from the model of the whole board
+ */
+void MATRIX_model(void);
+
+/*
+ * Description:
+ * Hold the keys a_keys, KEYPAD_MATRIX_BIT bits, and release the others
+ */
+void MATRIX_pressKeys(uint16 a_keys);
+
+/*
+ * Description:
+ * Hold only the key at a_row, a_col, or release all the keys if a_row is negative
+ */
+void MATRIX_pressKey(sint8 a_row, sint8 a_col);
+
+#endif /* MATRIX_H_ */
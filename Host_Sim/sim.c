@@ -0,0 +1,1032 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : sim.c
+ *  Description : Source file for the host GPIO and register mock with VCD recording
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#include "sim.h"
+#include "gpio.h" /* For the port IDs */
+#include <avr/io.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Addresses of the port registers, PORTA is the highest and PORTD the lowest */
+#define SIM_PORT_ADDR(PORT)               (0x3B - (3 * (PORT)))
+#define SIM_DDR_ADDR(PORT)                (0x3A - (3 * (PORT)))
+#define SIM_PIN_ADDR(PORT)                (0x39 - (3 * (PORT)))
+
+#define SIM_SREG_ADDR                     0x5F
+#define SIM_GICR_ADDR                     0x5B
+#define SIM_GIFR_ADDR                     0x5A
+#define SIM_MCUCR_ADDR                    0x55
+#define SIM_MCUCSR_ADDR                   0x54
+#define SIM_UBRRH_ADDR                    0x40
+#define SIM_UDR_ADDR                      0x2C
+#define SIM_UCSRA_ADDR                    0x2B
+#define SIM_UCSRB_ADDR                    0x2A
+#define SIM_UBRRL_ADDR                    0x29
+
+/* Bits of UCSRA the CPU writes, the others are the flags of the simulator */
+#define SIM_UCSRA_WRITE_MASK              ((1 << U2X) | (1 << MPCM))
+
+/* Start, 8 data and stop bits, the frame of the UART driver */
+#define SIM_UART_FRAME_BITS               10
+
+/* The sleep modes in the SM bits of MCUCR */
+#define SIM_SLEEP_MODE_MASK               ((1 << SM2) | (1 << SM1) | (1 << SM0))
+#define SIM_SLEEP_MODE_IDLE               0
+
+/* One CPU cycle in the 1ns time scale of the VCD file */
+#define SIM_NS_PER_CYCLE                  (1000000000ULL / F_CPU)
+
+/*------------------------------------------------------------------------------
+ *  							Global Variables
+ *----------------------------------------------------------------------------*/
+
+/*
+ * The register file the drivers read and write, and its copy at the last commit
+ */
+static volatile uint8 g_regs[SIM_NUM_REGS];
+static uint8 g_committed[SIM_NUM_REGS];
+
+static uint64 g_cycles = 0;
+/* Time of the last access, the writes it made happened at this time */
+static uint64 g_lastAccess = 0;
+
+/* Inputs driven from outside the MCU */
+static uint8 g_inputDriven[SIM_NUM_PORTS];
+static uint8 g_inputLevel[SIM_NUM_PORTS];
+
+/* Pin levels recorded last, LOGIC_LOW, LOGIC_HIGH or SIM_FLOATING */
+static uint8 g_levels[SIM_NUM_PORTS][8];
+
+/* External interrupt flags, the bits of GIFR */
+static uint8 g_intFlags = 0;
+/* Bits of INT0 - INT2 in GICR, the INTFx bits of GIFR are in the same places */
+static const uint8 g_intBits[SIM_VECTOR_INT2 + 1] = {1 << INT0, 1 << INT1, 1 << INT2};
+
+static void (*g_model)(void) = NULL_PTR;
+static void (*g_vectors[SIM_NUM_VECTORS])(void);
+
+static boolean g_inModel = FALSE;
+static boolean g_inIsr = FALSE;
+/* The vector being served, SIM_NUM_VECTORS outside the interrupts */
+static SIM_VectorType g_isrVector = SIM_NUM_VECTORS;
+
+/* Cost of the last run of every vector, and the functions called by the running one */
+static uint32 g_vectorCycles[SIM_NUM_VECTORS];
+static uint8 g_vectorCalls[SIM_NUM_VECTORS];
+static uint8 g_isrCalls = 0;
+
+/* Periodic interrupt, period 0 while it is stopped */
+static uint64 g_tickPeriod = 0;
+static uint64 g_nextTick = 0;
+static boolean g_tickFlag = FALSE;
+
+/* Actions from outside the MCU, a free slot has no action */
+static struct
+{
+	uint64 cycles;
+	void (*action)(uint8 a_arg);
+	uint8 arg;
+} g_actions[SIM_MAX_ACTIONS];
+static boolean g_inEvents = FALSE;
+
+/* The CPU sleeps, the interrupts are served once it wakes up */
+static boolean g_sleeping = FALSE;
+/* Set in the sleep modes that stop the clock of the timers, the UART and the edge detection */
+static boolean g_clockStopped = FALSE;
+
+/*
+ * UART: the byte being shifted out and the time its stop bit ends (0 while idle),
+ * the byte waiting in UDR for the shift register, and the flags of UCSRA
+ */
+static uint8 g_txShiftByte;
+static uint64 g_txShiftEnd = 0;
+static uint8 g_txBuffer;
+static boolean g_txBufferFull = FALSE;
+static boolean g_txComplete = FALSE;
+static uint8 g_rxByte;
+static boolean g_rxFull = FALSE;
+/* UDR was accessed outside the RX interrupt, the driver writes it */
+static boolean g_udrWrite = FALSE;
+/* UBRRH shares its address with UCSRC, URSEL selects which one is written */
+static uint8 g_ubrrh = 0;
+static void (*g_txHook)(uint8 a_byte, uint64 a_doneCycles) = NULL_PTR;
+static uint16 g_cutBytes = 0;
+
+static FILE *g_vcd = NULL_PTR;
+static uint64 g_vcdTime = 0;
+
+/*------------------------------------------------------------------------------
+ *  							Private Functions
+ *----------------------------------------------------------------------------*/
+
+static char SIM_vcdId(uint8 a_port, uint8 a_pin)
+{
+	return (char)('!' + (a_port * 8) + a_pin);
+}
+
+static char SIM_vcdValue(uint8 a_level)
+{
+	return (a_level == SIM_FLOATING) ? 'z' : (char)('0' + a_level);
+}
+
+/*
+ * Description:
+ * The level a pin has now: the MCU output, the outside driver, the pull up or floating
+ */
+static uint8 SIM_pinLevel(uint8 a_port, uint8 a_pin)
+{
+	uint8 bit = 1 << a_pin;
+
+	if(g_committed[SIM_DDR_ADDR(a_port)] & bit)
+	{
+		return (g_committed[SIM_PORT_ADDR(a_port)] & bit) ? LOGIC_HIGH : LOGIC_LOW;
+	}
+	if(g_inputDriven[a_port] & bit)
+	{
+		return (g_inputLevel[a_port] & bit) ? LOGIC_HIGH : LOGIC_LOW;
+	}
+	if(g_committed[SIM_PORT_ADDR(a_port)] & bit)
+	{
+		return LOGIC_HIGH;
+	}
+	return SIM_FLOATING;
+}
+
+/*
+ * Description:
+ * Set the flag of an external interrupt if its pin changed the way its sense asks
+ */
+static void SIM_detectEdge(uint8 a_flag, uint8 a_sense, boolean a_isInt2, uint8 a_old, uint8 a_new)
+{
+	boolean fell = (a_old == LOGIC_HIGH) && (a_new != LOGIC_HIGH);
+	boolean rose = (a_old != LOGIC_HIGH) && (a_new == LOGIC_HIGH);
+
+	/* INT2 is asynchronous, the edges of INT0 and INT1 are sampled with the I/O clock */
+	if(g_clockStopped && !a_isInt2)
+	{
+		return;
+	}
+
+	if(a_isInt2)
+	{
+		/* ISC2: 0 falling, 1 rising */
+		if(a_sense ? rose : fell)
+		{
+			g_intFlags |= a_flag;
+		}
+	}
+	else if(((a_sense == 1) && (fell || rose)) || ((a_sense == 2) && fell) || ((a_sense == 3) && rose))
+	{
+		g_intFlags |= a_flag;
+	}
+}
+
+/*
+ * Description:
+ * Record the pins that changed at a_time and set the external interrupt flags
+ */
+static void SIM_updateLevels(uint64 a_time)
+{
+	uint8 port, pin, level, old;
+
+	for(port = 0; port < SIM_NUM_PORTS; port++)
+	{
+		for(pin = 0; pin < 8; pin++)
+		{
+			level = SIM_pinLevel(port, pin);
+			old = g_levels[port][pin];
+			if(level == old)
+			{
+				continue;
+			}
+			g_levels[port][pin] = level;
+
+			if((port == PORTD_ID) && (pin == 2))
+			{
+				SIM_detectEdge(1 << INTF0, (g_committed[SIM_MCUCR_ADDR] >> ISC00) & 3, FALSE, old, level);
+			}
+			else if((port == PORTD_ID) && (pin == 3))
+			{
+				SIM_detectEdge(1 << INTF1, (g_committed[SIM_MCUCR_ADDR] >> ISC10) & 3, FALSE, old, level);
+			}
+			else if((port == PORTB_ID) && (pin == 2))
+			{
+				SIM_detectEdge(1 << INTF2, (g_committed[SIM_MCUCSR_ADDR] >> ISC2) & 1, TRUE, old, level);
+			}
+
+			if(g_vcd != NULL_PTR)
+			{
+				if(a_time != g_vcdTime)
+				{
+					fprintf(g_vcd, "#%llu\n", (unsigned long long)(a_time * SIM_NS_PER_CYCLE));
+					g_vcdTime = a_time;
+				}
+				fprintf(g_vcd, "%c%c\n", SIM_vcdValue(level), SIM_vcdId(port, pin));
+			}
+		}
+	}
+}
+
+/*
+ * Description:
+ * Let the circuit model answer the new outputs, then record the pins
+ */
+static void SIM_runModel(uint64 a_time)
+{
+	SIM_updateLevels(a_time);
+	if((g_model != NULL_PTR) && !g_inModel)
+	{
+		g_inModel = TRUE;
+		g_model();
+		g_inModel = FALSE;
+		SIM_updateLevels(a_time);
+	}
+}
+
+/*
+ * Description:
+ * Cycles of one frame at the baud rate set in UBRR, U2X halves the cycles per bit
+ */
+static uint64 SIM_uartFrameCycles(void)
+{
+	uint16 ubrr = ((uint16)(g_ubrrh & 0x0F) << 8) | g_committed[SIM_UBRRL_ADDR];
+	uint8 cyclesPerCount = (g_committed[SIM_UCSRA_ADDR] & (1 << U2X)) ? 8 : 16;
+
+	return (uint64)SIM_UART_FRAME_BITS * (ubrr + 1) * cyclesPerCount;
+}
+
+/*
+ * Description:
+ * A byte written to UDR goes to the shift register if it is empty, otherwise it
+ * waits in UDR (UDRE is clear), a byte written over a waiting one replaces it
+ */
+static void SIM_uartWrite(uint8 a_byte)
+{
+	if(g_txShiftEnd == 0)
+	{
+		g_txShiftByte = a_byte;
+		g_txShiftEnd = g_lastAccess + SIM_uartFrameCycles();
+	}
+	else
+	{
+		g_txBuffer = a_byte;
+		g_txBufferFull = TRUE;
+	}
+}
+
+/*
+ * Description:
+ * The stop bit of the byte in the shift register is sent: hand the byte to the
+ * hook, then start the waiting byte or set TXC
+ */
+static void SIM_uartShiftDone(void)
+{
+	uint64 done = g_txShiftEnd;
+
+	if(g_txHook != NULL_PTR)
+	{
+		g_txHook(g_txShiftByte, done);
+	}
+
+	if(g_txBufferFull)
+	{
+		g_txShiftByte = g_txBuffer;
+		g_txBufferFull = FALSE;
+		g_txShiftEnd = done + SIM_uartFrameCycles();
+	}
+	else
+	{
+		g_txShiftEnd = 0;
+		g_txComplete = TRUE;
+	}
+}
+
+/*
+ * Description:
+ * Time of the next tick, end of frame or action, the tick and the UART wait while
+ * the clock is stopped. Returns 0xFFFFFFFFFFFFFFFF if nothing will ever happen
+ */
+static uint64 SIM_nextEventTime(void)
+{
+	uint64 next = 0xFFFFFFFFFFFFFFFFULL;
+	uint8 i;
+
+	for(i = 0; i < SIM_MAX_ACTIONS; i++)
+	{
+		if((g_actions[i].action != NULL_PTR) && (g_actions[i].cycles < next))
+		{
+			next = g_actions[i].cycles;
+		}
+	}
+	if(!g_clockStopped)
+	{
+		if((g_tickPeriod != 0) && (g_nextTick < next))
+		{
+			next = g_nextTick;
+		}
+		if((g_txShiftEnd != 0) && (g_txShiftEnd < next))
+		{
+			next = g_txShiftEnd;
+		}
+	}
+
+	return next;
+}
+
+/*
+ * Description:
+ * Run the ticks, the ends of frames and the actions whose time has come, the
+ * earliest first. Actions may drive the inputs and so call the vectors
+ */
+static void SIM_runEvents(void)
+{
+	uint64 next;
+	uint8 i;
+
+	/* The vectors called by the actions access the registers too */
+	if(g_inEvents)
+	{
+		return;
+	}
+	g_inEvents = TRUE;
+
+	while((next = SIM_nextEventTime()) <= g_cycles)
+	{
+		if(!g_clockStopped && (g_tickPeriod != 0) && (g_nextTick == next))
+		{
+			g_tickFlag = TRUE;
+			g_nextTick += g_tickPeriod;
+		}
+		else if(!g_clockStopped && (g_txShiftEnd == next))
+		{
+			SIM_uartShiftDone();
+		}
+		else
+		{
+			for(i = 0; i < SIM_MAX_ACTIONS; i++)
+			{
+				if((g_actions[i].action != NULL_PTR) && (g_actions[i].cycles == next))
+				{
+					void (*action)(uint8 a_arg) = g_actions[i].action;
+
+					/* Free the slot first, the action may ask for another one */
+					g_actions[i].action = NULL_PTR;
+					action(g_actions[i].arg);
+					break;
+				}
+			}
+		}
+	}
+
+	g_inEvents = FALSE;
+}
+
+/*
+ * Description:
+ * Commit the writes of the last access at the time it was made
+ */
+static void SIM_commit(void)
+{
+	boolean changed = FALSE;
+	uint8 addr;
+
+	if(g_udrWrite)
+	{
+		/* Writing the same byte again is a new byte to send, so it is not compared */
+		g_udrWrite = FALSE;
+		g_committed[SIM_UDR_ADDR] = g_regs[SIM_UDR_ADDR];
+		SIM_uartWrite(g_regs[SIM_UDR_ADDR]);
+	}
+
+	for(addr = 0x20; addr < SIM_NUM_REGS; addr++)
+	{
+		if(g_regs[addr] == g_committed[addr])
+		{
+			continue;
+		}
+		if(addr == SIM_GIFR_ADDR)
+		{
+			/* The flags are cleared by writing one to them */
+			g_intFlags &= ~g_regs[addr];
+			g_regs[addr] = 0;
+			continue;
+		}
+		if(addr == SIM_UCSRA_ADDR)
+		{
+			/* TXC is cleared by writing one to it, RXC and UDRE are read only */
+			if(g_regs[addr] & (1 << TXC))
+			{
+				g_txComplete = FALSE;
+			}
+			g_regs[addr] &= SIM_UCSRA_WRITE_MASK;
+		}
+		if((addr == SIM_UBRRH_ADDR) && !(g_regs[addr] & (1 << URSEL)))
+		{
+			g_ubrrh = g_regs[addr];
+		}
+		g_committed[addr] = g_regs[addr];
+		changed = TRUE;
+	}
+
+	if(changed)
+	{
+		SIM_runModel(g_lastAccess);
+	}
+}
+
+/*
+ * Description:
+ * Return TRUE if the interrupt is enabled and pending. While the clock is stopped
+ * only the interrupts that can wake the CPU up are pending
+ */
+static boolean SIM_isPending(uint8 a_vector)
+{
+	boolean lowLevel;
+
+	if(g_vectors[a_vector] == NULL_PTR)
+	{
+		return FALSE;
+	}
+
+	switch(a_vector)
+	{
+	case SIM_VECTOR_INT0:
+	case SIM_VECTOR_INT1:
+	case SIM_VECTOR_INT2:
+		/* A low level interrupt has no flag, it runs while the pin stays low */
+		lowLevel = ((a_vector == SIM_VECTOR_INT0) && (((g_committed[SIM_MCUCR_ADDR] >> ISC00) & 3) == 0) &&
+		            (g_levels[PORTD_ID][2] == LOGIC_LOW)) ||
+		           ((a_vector == SIM_VECTOR_INT1) && (((g_committed[SIM_MCUCR_ADDR] >> ISC10) & 3) == 0) &&
+		            (g_levels[PORTD_ID][3] == LOGIC_LOW));
+
+		return (g_committed[SIM_GICR_ADDR] & g_intBits[a_vector]) &&
+		       ((g_intFlags & g_intBits[a_vector]) || lowLevel);
+	case SIM_VECTOR_TICK:
+		return !g_clockStopped && g_tickFlag;
+	case SIM_VECTOR_USART_RXC:
+		/* RXC stays set until the vector reads UDR */
+		return !g_clockStopped && g_rxFull && (g_committed[SIM_UCSRB_ADDR] & (1 << RXCIE));
+	default:
+		return FALSE;
+	}
+}
+
+/*
+ * Description:
+ * Call the vectors of the enabled pending interrupts, like the CPU does between two
+ * instructions. Returns TRUE if a vector was called
+ */
+static boolean SIM_serveInterrupts(void)
+{
+	boolean served = FALSE;
+	uint64 start;
+	uint8 sreg;
+	uint8 vector;
+
+	for(vector = 0; vector < SIM_NUM_VECTORS; vector++)
+	{
+		if(g_inIsr || g_sleeping || !(g_committed[SIM_SREG_ADDR] & (1 << 7)))
+		{
+			return served;
+		}
+
+		if(SIM_isPending(vector))
+		{
+			if(vector <= SIM_VECTOR_INT2)
+			{
+				g_intFlags &= ~g_intBits[vector];
+			}
+			else if(vector == SIM_VECTOR_TICK)
+			{
+				g_tickFlag = FALSE;
+			}
+
+			sreg = g_committed[SIM_SREG_ADDR];
+			g_regs[SIM_SREG_ADDR] = g_committed[SIM_SREG_ADDR] = sreg & ~(1 << 7);
+			g_inIsr = TRUE;
+			g_isrVector = vector;
+			g_isrCalls = 0;
+			start = g_cycles;
+			g_cycles += SIM_ISR_ENTRY_CYCLES + SIM_ISR_SAVE_CYCLES;
+
+			g_vectors[vector]();
+
+			SIM_commit();
+
+			/*
+			 * The call clobbered registers are saved in the prologue, they are charged
+			 * here once it is known that the vector called a function
+			 */
+			if(g_isrCalls != 0)
+			{
+				g_cycles += SIM_ISR_CLOBBERED_REGS * SIM_PUSH_POP_CYCLES;
+			}
+			g_cycles += SIM_ISR_EXIT_CYCLES;
+			g_vectorCycles[vector] = (uint32)(g_cycles - start);
+			g_vectorCalls[vector] = g_isrCalls;
+			g_isrVector = SIM_NUM_VECTORS;
+			g_inIsr = FALSE;
+			g_regs[SIM_SREG_ADDR] = g_committed[SIM_SREG_ADDR] = sreg;
+			served = TRUE;
+		}
+	}
+
+	return served;
+}
+
+/*------------------------------------------------------------------------------
+ *  							Function Definitions
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Called by every register access of the drivers (see avr/io.h)
+ */
+volatile uint8_t *SIM_access(uint8_t a_addr)
+{
+	uint8 port;
+
+	SIM_commit();
+	SIM_runEvents();
+	SIM_serveInterrupts();
+
+	g_cycles += SIM_ACCESS_CYCLES;
+	g_lastAccess = g_cycles;
+
+	for(port = 0; port < SIM_NUM_PORTS; port++)
+	{
+		if(a_addr == SIM_PIN_ADDR(port))
+		{
+			uint8 pin, value = 0;
+
+			SIM_runModel(g_cycles);
+			for(pin = 0; pin < 8; pin++)
+			{
+				if(g_levels[port][pin] == LOGIC_HIGH)
+				{
+					value |= (1 << pin);
+				}
+			}
+			g_regs[a_addr] = g_committed[a_addr] = value;
+		}
+	}
+
+	if(a_addr == SIM_GIFR_ADDR)
+	{
+		/* Modeled as write only, the flags are kept by the simulator */
+		g_regs[a_addr] = 0;
+	}
+	else if(a_addr == SIM_UCSRA_ADDR)
+	{
+		g_regs[a_addr] = g_committed[a_addr] = (g_committed[a_addr] & SIM_UCSRA_WRITE_MASK) |
+		                                       (g_rxFull ? (1 << RXC) : 0) |
+		                                       (g_txComplete ? (1 << TXC) : 0) |
+		                                       (g_txBufferFull ? 0 : (1 << UDRE));
+	}
+	else if(a_addr == SIM_UDR_ADDR)
+	{
+		/*
+		 * The drivers read UDR only in the RX vector, anywhere else it is written
+		 */
+		if(g_isrVector == SIM_VECTOR_USART_RXC)
+		{
+			g_regs[a_addr] = g_committed[a_addr] = g_rxByte;
+			g_rxFull = FALSE;
+		}
+		else
+		{
+			g_udrWrite = TRUE;
+		}
+	}
+
+	return &g_regs[a_addr];
+}
+
+volatile uint16_t *SIM_access16(uint8_t a_addr)
+{
+	SIM_access(a_addr + 1);
+	return (volatile uint16_t *)SIM_access(a_addr);
+}
+
+/*
+ * Description:
+ * Clear the registers, the inputs and the time then start recording every pin
+ * change in the VCD file a_vcdPath (NULL_PTR to record nothing)
+ */
+void SIM_init(const char *a_vcdPath)
+{
+	uint8 port, pin;
+
+	memset((void *)g_regs, 0, sizeof(g_regs));
+	memset(g_committed, 0, sizeof(g_committed));
+	memset(g_inputDriven, 0, sizeof(g_inputDriven));
+	memset(g_inputLevel, 0, sizeof(g_inputLevel));
+	memset(g_actions, 0, sizeof(g_actions));
+	g_cycles = 0;
+	g_lastAccess = 0;
+	g_intFlags = 0;
+	g_vcdTime = 0;
+	g_tickPeriod = 0;
+	g_tickFlag = FALSE;
+	g_sleeping = FALSE;
+	g_clockStopped = FALSE;
+	g_txShiftEnd = 0;
+	g_txBufferFull = FALSE;
+	g_txComplete = FALSE;
+	g_rxFull = FALSE;
+	g_udrWrite = FALSE;
+	g_ubrrh = 0;
+	g_cutBytes = 0;
+
+	for(port = 0; port < SIM_NUM_PORTS; port++)
+	{
+		for(pin = 0; pin < 8; pin++)
+		{
+			g_levels[port][pin] = SIM_FLOATING;
+		}
+	}
+
+	g_vcd = NULL_PTR;
+	if(a_vcdPath != NULL_PTR)
+	{
+		g_vcd = fopen(a_vcdPath, "w");
+		if(g_vcd == NULL_PTR)
+		{
+			perror(a_vcdPath);
+			return;
+		}
+
+		fprintf(g_vcd, "$timescale 1ns $end\n$scope module atmega32 $end\n");
+		for(port = 0; port < SIM_NUM_PORTS; port++)
+		{
+			for(pin = 0; pin < 8; pin++)
+			{
+				fprintf(g_vcd, "$var wire 1 %c P%c%u $end\n", SIM_vcdId(port, pin), 'A' + port, pin);
+			}
+		}
+		fprintf(g_vcd, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+		for(port = 0; port < SIM_NUM_PORTS; port++)
+		{
+			for(pin = 0; pin < 8; pin++)
+			{
+				fprintf(g_vcd, "z%c\n", SIM_vcdId(port, pin));
+			}
+		}
+		fprintf(g_vcd, "$end\n");
+	}
+}
+
+/*
+ * Description:
+ * Commit the last writes and close the VCD file
+ */
+void SIM_close(void)
+{
+	SIM_commit();
+	if(g_vcd != NULL_PTR)
+	{
+		fprintf(g_vcd, "#%llu\n", (unsigned long long)(g_cycles * SIM_NS_PER_CYCLE));
+		fclose(g_vcd);
+		g_vcd = NULL_PTR;
+	}
+}
+
+/*
+ * Description:
+ * Return the virtual time in CPU cycles
+ */
+uint64 SIM_getCycles(void)
+{
+	return g_cycles;
+}
+
+/*
+ * Description:
+ * Let a_cycles cycles pass as if the CPU was busy waiting, interrupts that become
+ * pending are served first. The events on the way are run at their time and the
+ * interrupts they raise are served then, their time makes the delay longer like it
+ * does for the counted loops of util/delay.h
+ */
+void SIM_delayCycles(uint64 a_cycles)
+{
+	uint64 next;
+	uint64 step;
+
+	SIM_commit();
+	SIM_runEvents();
+	SIM_serveInterrupts();
+
+	while(a_cycles > 0)
+	{
+		/* Inside an action the events wait for it to return */
+		next = SIM_nextEventTime();
+		step = ((next > g_cycles) && (next - g_cycles < a_cycles)) ? (next - g_cycles) : a_cycles;
+		g_cycles += step;
+		a_cycles -= step;
+		SIM_runEvents();
+		SIM_serveInterrupts();
+	}
+	g_lastAccess = g_cycles;
+}
+
+/*
+ * Description:
+ * Drive an input pin from outside the MCU to LOGIC_HIGH or LOGIC_LOW, or stop
+ * driving it. A pin that nobody drives reads its pull up, or 0 while floating
+ */
+void SIM_setInput(uint8 a_port, uint8 a_pin, uint8 a_level)
+{
+	g_inputDriven[a_port] |= (1 << a_pin);
+	if(a_level)
+	{
+		g_inputLevel[a_port] |= (1 << a_pin);
+	}
+	else
+	{
+		g_inputLevel[a_port] &= ~(1 << a_pin);
+	}
+
+	/* Inside the model the caller records the pins once it is done */
+	if(!g_inModel)
+	{
+		SIM_commit();
+		SIM_runModel(g_cycles);
+		SIM_serveInterrupts();
+	}
+}
+
+void SIM_releaseInput(uint8 a_port, uint8 a_pin)
+{
+	g_inputDriven[a_port] &= ~(1 << a_pin);
+
+	if(!g_inModel)
+	{
+		SIM_commit();
+		SIM_runModel(g_cycles);
+		SIM_serveInterrupts();
+	}
+}
+
+/*
+ * Description:
+ * Return the level of a pin as it is seen outside the MCU, LOGIC_HIGH, LOGIC_LOW or SIM_FLOATING
+ */
+uint8 SIM_getPin(uint8 a_port, uint8 a_pin)
+{
+	SIM_commit();
+	return SIM_pinLevel(a_port, a_pin);
+}
+
+/*
+ * Description:
+ * Set the model of the circuit around the MCU, it is called every time the MCU
+ * changes its outputs and before the MCU reads its inputs, so it can drive the
+ * inputs from the outputs with SIM_setInput (a keypad matrix for example)
+ */
+void SIM_setInputModel(void (*a_model)(void))
+{
+	g_model = a_model;
+}
+
+/*
+ * Description:
+ * Set the function the simulator calls for an interrupt, normally the ISR of the driver
+ */
+void SIM_setVector(SIM_VectorType a_vector, void (*a_isr)(void))
+{
+	g_vectors[a_vector] = a_isr;
+}
+
+/*
+ * Description:
+ * Return the cycles the last run of the vector took from the interrupt response to
+ * the end of RETI, and the number of functions it called
+ */
+uint32 SIM_getVectorCycles(SIM_VectorType a_vector)
+{
+	return g_vectorCycles[a_vector];
+}
+
+uint8 SIM_getVectorCalls(SIM_VectorType a_vector)
+{
+	return g_vectorCalls[a_vector];
+}
+
+/*
+ * Description:
+ * Start a periodic interrupt every a_period cycles served through SIM_VECTOR_TICK,
+ * like the Timer1 compare of the system clock (0 to stop it). It stops in the
+ * sleep modes other than idle, like Timer1
+ */
+void SIM_setTick(uint64 a_period)
+{
+	g_tickPeriod = a_period;
+	g_nextTick = g_cycles + a_period;
+	g_tickFlag = FALSE;
+}
+
+/*
+ * Description:
+ * Call a_action(a_arg) from outside the MCU when the virtual time reaches a_cycles,
+ * between two accesses or during a delay or a sleep.
+ * Returns FALSE if SIM_MAX_ACTIONS actions are already waiting
+ */
+boolean SIM_at(uint64 a_cycles, void (*a_action)(uint8 a_arg), uint8 a_arg)
+{
+	uint8 i;
+
+	for(i = 0; i < SIM_MAX_ACTIONS; i++)
+	{
+		if(g_actions[i].action == NULL_PTR)
+		{
+			g_actions[i].cycles = a_cycles;
+			g_actions[i].action = a_action;
+			g_actions[i].arg = a_arg;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/*
+ * Description:
+ * Set the function called for every byte written to UDR with the time its stop
+ * bit is sent, the transmitter sends 8N1 frames at the rate set in UBRR and U2X
+ */
+void SIM_setTxHook(void (*a_hook)(uint8 a_byte, uint64 a_doneCycles))
+{
+	g_txHook = a_hook;
+}
+
+/*
+ * Description:
+ * Put a byte in UDR as if it was received and set RXC, a byte not read yet is lost
+ */
+void SIM_receiveByte(uint8 a_byte)
+{
+	g_rxByte = a_byte;
+	g_rxFull = TRUE;
+
+	if(!g_inModel)
+	{
+		SIM_commit();
+		SIM_serveInterrupts();
+	}
+}
+
+/*
+ * Description:
+ * The SLEEP instruction: if SE is set in MCUCR, let the time pass until an interrupt
+ * is served. Outside the idle mode the tick and the transmitter are stopped
+ */
+void SIM_sleep(void)
+{
+	uint64 start;
+	uint64 next;
+	uint8 vector;
+	boolean pending = FALSE;
+
+	SIM_commit();
+	if(!(g_committed[SIM_MCUCR_ADDR] & (1 << SE)))
+	{
+		return;
+	}
+
+	start = g_cycles;
+	g_sleeping = TRUE;
+	g_clockStopped = ((g_committed[SIM_MCUCR_ADDR] & SIM_SLEEP_MODE_MASK) != SIM_SLEEP_MODE_IDLE);
+	if(g_clockStopped && (g_txShiftEnd != 0))
+	{
+		/* The shift register stops with its clock, the other side gets a broken frame */
+		g_cutBytes += g_txBufferFull ? 2 : 1;
+	}
+
+	while(!pending)
+	{
+		SIM_runEvents();
+		for(vector = 0; vector < SIM_NUM_VECTORS; vector++)
+		{
+			pending = pending || SIM_isPending(vector);
+		}
+		pending = pending && (g_committed[SIM_SREG_ADDR] & (1 << 7));
+		if(pending)
+		{
+			break;
+		}
+
+		next = SIM_nextEventTime();
+		if(next == 0xFFFFFFFFFFFFFFFFULL)
+		{
+			fprintf(stderr, "SIM: the CPU sleeps at %llu cycles and nothing can wake it up\n",
+			        (unsigned long long)g_cycles);
+			SIM_close();
+			exit(1);
+		}
+		g_cycles = next;
+	}
+	g_sleeping = FALSE;
+
+	if(g_clockStopped)
+	{
+		/* The stopped timer and frame go on from where they were */
+		g_clockStopped = FALSE;
+		g_cycles += SIM_START_UP_CYCLES;
+		if(g_tickPeriod != 0)
+		{
+			g_nextTick += g_cycles - start;
+		}
+		if(g_txShiftEnd != 0)
+		{
+			g_txShiftEnd += g_cycles - start;
+		}
+	}
+	g_cycles += SIM_WAKE_UP_CYCLES;
+	g_lastAccess = g_cycles;
+	SIM_serveInterrupts();
+}
+
+/*
+ * Description:
+ * Return the number of bytes the transmitter was still sending when a sleep mode
+ * stopped its clock, they are cut on the real MCU
+ */
+uint16 SIM_getCutBytes(void)
+{
+	return g_cutBytes;
+}
+
+/*
+ * Description:
+ * Busy wait delays of the drivers, they only move the virtual time
+ */
+void _delay_ms(double a_ms)
+{
+	SIM_delayCycles((uint64)((a_ms * F_CPU) / 1000.0));
+}
+
+void _delay_us(double a_us)
+{
+	SIM_delayCycles((uint64)((a_us * F_CPU) / 1000000.0));
+}
+
+/*
+ * Description:
+ * Not in the host C library, same behavior as the avr-libc one
+ */
+char *itoa(int a_value, char *a_str, int a_base)
+{
+	static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+	char tmp[34];
+	unsigned int value = (a_value < 0 && a_base == 10) ? (unsigned int)(-a_value) : (unsigned int)a_value;
+	int i = 0, j = 0;
+
+	do
+	{
+		tmp[i++] = digits[value % a_base];
+		value /= a_base;
+	} while(value != 0);
+
+	if(a_value < 0 && a_base == 10)
+	{
+		a_str[j++] = '-';
+	}
+	while(i > 0)
+	{
+		a_str[j++] = tmp[--i];
+	}
+	a_str[j] = '\0';
+
+	return a_str;
+}
+
+/*
+ * Description:
+ * Called at the entry of every function built with -finstrument-functions, a function
+ * other than the vector entered while an interrupt is served is a call the vector makes
+ * on the chip. The circuit models and the scheduled actions run outside the MCU
+ */
+void __cyg_profile_func_enter(void *a_fn, void *a_site)
+{
+	(void)a_site;
+
+	if(g_inIsr && !g_inModel && !g_inEvents && (a_fn != (void *)g_vectors[g_isrVector]))
+	{
+		if(g_isrCalls < 0xFF)
+		{
+			g_isrCalls++;
+		}
+		g_cycles += SIM_CALL_CYCLES;
+	}
+}
+
+void __cyg_profile_func_exit(void *a_fn, void *a_site)
+{
+	(void)a_fn;
+	(void)a_site;
+}
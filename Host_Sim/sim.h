@@ -0,0 +1,188 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : sim.h
+ *  Description : Header file for the host GPIO and register mock with VCD recording
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include "std_types.h"
+
+/*------------------------------------------------------------------------------
+ * 					 Pre-Processor Constants and Configurations
+ *----------------------------------------------------------------------------*/
+
+/* Data memory addresses of the IO registers, the register file covers 0x00 - 0x5F */
+#define SIM_NUM_REGS                      0x60
+
+/* Ports of the ATmega32, numbered like PORTA_ID - PORTD_ID of the GPIO driver */
+#define SIM_NUM_PORTS                     4
+
+/* Level of a pin that nobody drives and has no pull up, it reads 0 */
+#define SIM_FLOATING                      2
+
+/*
+ * Virtual cycles charged for a register access (LDS/STS at -O0), for entering an
+ * interrupt (response and vector jump) and for leaving it (RETI).
+ * The C code between two accesses is not counted, only the accesses and the delays
+ */
+#define SIM_ACCESS_CYCLES                 2
+#define SIM_ISR_ENTRY_CYCLES              7
+#define SIM_ISR_EXIT_CYCLES               4
+
+/*
+ * Prologue and epilogue of an avr-gcc -O0 ISR: every vector saves r0, r1 and SREG and
+ * sets up the Y frame pointer (push r1, push r0, in r0 SREG, push r0, clr r1, push r28,
+ * push r29, in r28 SPL, in r29 SPH and the reverse before RETI). A vector that calls a
+ * function also saves the call clobbered r18-r27, r30 and r31, a push and a pop each,
+ * and every call costs a CALL and a RET. The calls are seen through the hooks of
+ * -finstrument-functions (see the Makefile). The registers a vector without calls uses
+ * for its own work are not counted
+ */
+#define SIM_ISR_SAVE_CYCLES               25
+#define SIM_ISR_CLOBBERED_REGS            12
+#define SIM_PUSH_POP_CYCLES               4
+#define SIM_CALL_CYCLES                   8
+
+/*
+ * Cycles the CPU is halted when an interrupt wakes it up, and the start up time of the
+ * internal RC oscillator added in the sleep modes that stop the clock
+ */
+#define SIM_WAKE_UP_CYCLES                4
+#define SIM_START_UP_CYCLES               6
+
+/* Actions waiting for their time in SIM_at */
+#define SIM_MAX_ACTIONS                   8
+
+/*------------------------------------------------------------------------------
+ *  							Data Types Declarations
+ *----------------------------------------------------------------------------*/
+
+typedef enum
+{
+	SIM_VECTOR_INT0,
+	SIM_VECTOR_INT1,
+	SIM_VECTOR_INT2,
+	SIM_VECTOR_TICK,
+	SIM_VECTOR_USART_RXC,
+	SIM_NUM_VECTORS
+}SIM_VectorType;
+
+/*------------------------------------------------------------------------------
+ *  							Function Declarations
+ *----------------------------------------------------------------------------*/
+
+/*
+ * Description:
+ * Clear the registers, the inputs and the time then start recording every pin
+ * change in the VCD file a_vcdPath (NULL_PTR to record nothing)
+ */
+void SIM_init(const char *a_vcdPath);
+
+/*
+ * Description:
+ * Commit the last writes and close the VCD file
+ */
+void SIM_close(void);
+
+/*
+ * Description:
+ * Return the virtual time in CPU cycles
+ */
+uint64 SIM_getCycles(void);
+
+/*
+ * Description:
+ * Let a_cycles cycles pass as if the CPU was busy waiting, interrupts that become
+ * pending are served first
+ */
+void SIM_delayCycles(uint64 a_cycles);
+
+/*
+ * Description:
+ * Drive an input pin from outside the MCU to LOGIC_HIGH or LOGIC_LOW, or stop
+ * driving it. A pin that nobody drives reads its pull up, or 0 while floating
+ */
+void SIM_setInput(uint8 a_port, uint8 a_pin, uint8 a_level);
+void SIM_releaseInput(uint8 a_port, uint8 a_pin);
+
+/*
+ * Description:
+ * Return the level of a pin as it is seen outside the MCU, LOGIC_HIGH, LOGIC_LOW or SIM_FLOATING
+ */
+uint8 SIM_getPin(uint8 a_port, uint8 a_pin);
+
+/*
+ * Description:
+ * Set the model of the circuit around the MCU, it is called every time the MCU
+ * changes its outputs and before the MCU reads its inputs, so it can drive the
+ * inputs from the outputs with SIM_setInput (a keypad matrix for example)
+ */
+void SIM_setInputModel(void (*a_model)(void));
+
+/*
+ * Description:
+ * Set the function the simulator calls for an interrupt, normally the ISR of the driver
+ */
+void SIM_setVector(SIM_VectorType a_vector, void (*a_isr)(void));
+
+/*
+ * Description:
+ * Return the cycles the last run of the vector took from the interrupt response to
+ * the end of RETI, and the number of functions it called
+ */
+uint32 SIM_getVectorCycles(SIM_VectorType a_vector);
+uint8 SIM_getVectorCalls(SIM_VectorType a_vector);
+
+/*
+ * Description:
+ * Start a periodic interrupt every a_period cycles served through SIM_VECTOR_TICK,
+ * like the Timer1 compare of the system clock (0 to stop it). It stops in the
+ * sleep modes other than idle, like Timer1
+ */
+void SIM_setTick(uint64 a_period);
+
+/*
+ * Description:
+ * Call a_action(a_arg) from outside the MCU when the virtual time reaches a_cycles,
+ * between two accesses or during a delay or a sleep.
+ * Returns FALSE if SIM_MAX_ACTIONS actions are already waiting
+ */
+boolean SIM_at(uint64 a_cycles, void (*a_action)(uint8 a_arg), uint8 a_arg);
+
+/*
+ * Description:
+ * Set the function called for every byte written to UDR with the time its stop
+ * bit is sent, the transmitter sends 8N1 frames at the rate set in UBRR and U2X
+ */
+void SIM_setTxHook(void (*a_hook)(uint8 a_byte, uint64 a_doneCycles));
+
+/*
+ * Description:
+ * Put a byte in UDR as if it was received and set RXC, a byte not read yet is lost
+ */
+void SIM_receiveByte(uint8 a_byte);
+
+/*
+ * Description:
+ * The SLEEP instruction: if SE is set in MCUCR, let the time pass until an interrupt
+ * is served. Outside the idle mode the tick and the transmitter are stopped
+ */
+void SIM_sleep(void);
+
+/*
+ * Description:
+ * Return the number of bytes the transmitter was still sending when a sleep mode
+ * stopped its clock, they are cut on the real MCU
+ */
+uint16 SIM_getCutBytes(void);
+
+/*
+ * Description:
+ * Not declared by the host stdlib.h, the LCD driver uses it like avr-libc
+ */
+char *itoa(int a_value, char *a_str, int a_base);
+
+#endif /* SIM_H_ */
@@ -0,0 +1,14 @@
+/*------------------------------------------------------------------------------
+ *  Module      : Host Simulator
+ *  File        : delay.h
+ *  Description : Busy wait delays of the host build, they advance the virtual time
+ *  Author      : Yousef Tantawy
+ *----------------------------------------------------------------------------*/
+
+#ifndef SIM_UTIL_DELAY_H_
+#define SIM_UTIL_DELAY_H_
+
+void _delay_ms(double a_ms);
+void _delay_us(double a_us);
+
+#endif /* SIM_UTIL_DELAY_H_ */